@@ -12,170 +12,623 @@
 
 Bank::Bank(juce::AudioFormatManager& afm) : formatManager(afm)
 {
-    
-        transportSource.setSource(nullptr);
-        readerSource = nullptr;
-        
         adsrParams.attack = 0.1f;  // Fast attack
         adsrParams.decay = 0.0f;    // Short decay
         adsrParams.sustain = 1.0f;  // Sustain level
         adsrParams.release = 0.2f;  // Release time
-    
+
         adsr.setParameters(adsrParams);
-    
+
 }
 
 Bank::~Bank()
 {
-   
-        transportSource.setSource(nullptr);
-        readerSource = nullptr;
+        setSample(nullptr);
 }
 
 void Bank::prepareToPlay(int samplesPerBlockExpected , double sampleRate)
 {
-  
-        transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-        resampleSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+        currentSampleRate = sampleRate;
+
+        adsr.setSampleRate(sampleRate);
+
+        gainSmoothed.reset(sampleRate, 0.05);
+        panSmoothed.reset(sampleRate, 0.05);
+        speedSmoothed.reset(sampleRate, 0.05);
+
+        declickLength = juce::jmax(1, juce::roundToInt(retriggerDeclickSeconds * sampleRate));
+        declickSamplesLeft = 0;
+
+        effects.prepare(sampleRate, samplesPerBlockExpected);
+        effectsBuffer.setSize(2, samplesPerBlockExpected);
+        modulation.prepare(sampleRate, samplesPerBlockExpected);
+        granular.prepare(sampleRate, samplesPerBlockExpected);
 }
 
 void Bank::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
 {
-    
-    if(readerSource == nullptr)
+    bufferToFill.clearActiveBufferRegion();
+    renderNextBlock(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+}
+
+void Bank::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    const juce::SpinLock::ScopedTryLockType lock(sampleLock);
+
+    if(!lock.isLocked() || sample == nullptr) //a new file is being swapped in
+    {
+        return;
+    }
+
+    handlePendingRequests();
+
+    if(!voiceActive && declickSamplesLeft == 0)
+    {
+        return;
+    }
+
+    const Interpolation interpolationType = interpolation;
+    const int maximumLength = effectsBuffer.getNumSamples();
+
+    if(maximumLength == 0) //not prepared yet
     {
         return;
     }
-    
-    auto l = loopRegion;
-    
-    if(l.proper())
+
+    const int numOutputChannels = juce::jmin(outputBuffer.getNumChannels(), 2);
+    const bool effectsEnabled = effects.isEnabled();
+
+    //blocks bigger than the one we prepared for are done in pieces rather than reallocating
+    for(int position = 0; position < numSamples && (voiceActive || declickSamplesLeft > 0); position += maximumLength)
     {
-        auto p = getPositionRelative();
-        
-        if(p >= l.end()) //if reaches the end of loop region
+        const int length = juce::jmin(numSamples - position, maximumLength);
+
+        modulation.process(length);
+
+        //with effects on the voice goes into effectsBuffer first, otherwise straight into the output
+        auto& target = effectsEnabled ? effectsBuffer : outputBuffer;
+        const int targetStart = effectsEnabled ? 0 : startSample + position;
+
+        if(effectsEnabled)
+        {
+            effectsBuffer.clear(0, length);
+        }
+
+        if(voiceActive && voiceGranular)
+        {
+            renderGranular(target, targetStart, length);
+        }else if(voiceActive)
         {
-            setPositionRelative(l.start());
-            adsr.noteOff();
-            paused = true;
+            renderVoice(target, targetStart, length, interpolationType);
         }
-        
-        if(p < l.start()) //before loop region, skips to the loop region
+
+        if(declickSamplesLeft > 0)
         {
-            setPositionRelative(l.start());
+            renderDeclick(target, targetStart, length);
         }
-       
+
+        if(effectsEnabled)
+        {
+            processEffects(length);
+
+            if(numOutputChannels > 1)
+            {
+                outputBuffer.addFrom(0, startSample + position, effectsBuffer, 0, 0, length);
+                outputBuffer.addFrom(1, startSample + position, effectsBuffer, 1, 0, length);
+            }else
+            {
+                outputBuffer.addFrom(0, startSample + position, effectsBuffer, 0, 0, length, 0.5f);
+                outputBuffer.addFrom(0, startSample + position, effectsBuffer, 1, 0, length, 0.5f);
+            }
+        }
+    }
+
+    positionRelative.store(static_cast<float>(readPosition / voiceSample->getNumSamples()));
+}
+
+void Bank::processEffects(int numSamples)
+{
+    if(!modulation.isRouted(ModulationMatrix::Destination::cutoff))
+    {
+        effects.setCutoffModulation(0.0f);
+        effects.process(effectsBuffer, 0, numSamples);
+        return;
+    }
+
+    //the filter's coefficients move once per control interval rather than every sample
+    const int interval = modulation.getControlInterval();
+    const float* cutoffOctaves = modulation.getCutoffOctaves();
+
+    for(int position = 0; position < numSamples; position += interval)
+    {
+        effects.setCutoffModulation(cutoffOctaves[position]);
+        effects.process(effectsBuffer, position, juce::jmin(interval, numSamples - position));
+    }
+}
+
+void Bank::endVoice()
+{
+    voiceActive = false;
+    adsr.reset();
+
+    if(!isListenerBank)
+    {
+        readPosition = voiceRegion.start() * voiceSample->getNumSamples(); //playhead goes back to the start
+    }
+}
+
+void Bank::renderDeclick(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    const int length = juce::jmin(numSamples, declickSamplesLeft);
+    const float rampStep = 1.0f / static_cast<float>(declickLength);
+
+    float* outputLeft = outputBuffer.getWritePointer(0, startSample);
+    float* outputRight = juce::jmin(outputBuffer.getNumChannels(), 2) > 1 ? outputBuffer.getWritePointer(1, startSample) : nullptr;
+
+    for(int i = 0; i < length; i++)
+    {
+        const float ramp = static_cast<float>(declickSamplesLeft - i) * rampStep;
+        outputLeft[i] += declickLeft * ramp;
+
+        if(outputRight != nullptr)
+        {
+            outputRight[i] += declickRight * ramp;
+        }
+    }
+
+    declickSamplesLeft -= length;
+}
+
+void Bank::renderVoice(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples, Interpolation interpolationType)
+{
+    if(interpolationType == Interpolation::hermite)
+    {
+        renderVoice<Interpolation::hermite>(outputBuffer, startSample, numSamples);
+    }else
+    {
+        renderVoice<Interpolation::linear>(outputBuffer, startSample, numSamples);
+    }
+}
+
+void Bank::setEffectParameters(const BankEffects::Parameters& parameters)
+{
+    effects.setParameters(parameters);
+}
+
+void Bank::setModulationParameters(const ModulationMatrix::Parameters& parameters)
+{
+    modulation.setParameters(parameters);
+}
+
+void Bank::setGranularParameters(const GranularEngine::Parameters& parameters)
+{
+    granular.setParameters(parameters);
+}
+
+//4 point, 3rd order hermite, index - 1 is held at the first sample and the padding covers index + 2
+static inline float hermiteInterpolate(const float* source, int index, float fraction)
+{
+    const float previous = source[juce::jmax(0, index - 1)];
+    const float current = source[index];
+    const float next = source[index + 1];
+    const float afterNext = source[index + 2];
+
+    const float c1 = 0.5f * (next - previous);
+    const float c2 = previous - 2.5f * current + 2.0f * next - 0.5f * afterNext;
+    const float c3 = 0.5f * (afterNext - previous) + 1.5f * (current - next);
+
+    return ((c3 * fraction + c2) * fraction + c1) * fraction + current;
+}
+
+template <Bank::Interpolation interpolationType>
+void Bank::renderVoice(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    const int numOutputChannels = juce::jmin(outputBuffer.getNumChannels(), 2);
+    const int numSourceChannels = voiceSample->getNumChannels();
+
+    const float* sourceLeft = voiceSample->getReadPointer(0);
+    const float* sourceRight = voiceSample->getReadPointer(juce::jmin(1, numSourceChannels - 1));
+
+    float* outputLeft = outputBuffer.getWritePointer(0, startSample);
+    float* outputRight = numOutputChannels > 1 ? outputBuffer.getWritePointer(1, startSample) : nullptr;
+
+    //file samples per output sample at normal speed
+    const double baseIncrement = voiceSample->getSampleRate() / currentSampleRate;
+
+    //filled for this span by the matrix, 1 and 0 when nothing is routed to them
+    const float* pitchRatios = modulation.getPitchRatios();
+    const float* panOffsets = modulation.getPanOffsets();
+
+    float lastLeft = lastOutputLeft, lastRight = lastOutputRight; //kept in locals, the output could alias the members
+
+    for(int i = 0; i < numSamples; i++)
+    {
+        //distance left before the boundary in whichever direction the voice is reading, so reverse costs a multiply rather than a branch
+        const double remaining = (voiceBoundary - readPosition) * voiceDirection;
+
+        if((remaining <= 0.0 && !reachedBoundary()) || !adsr.isActive()) //reached the end of the region or released
+        {
+            endVoice();
+            break;
+        }
+
+        const int index = static_cast<int>(readPosition);
+        const float fraction = static_cast<float>(readPosition - index);
+
+        //the smoothers keep moving while a lock overrides them so there's no jump on the next unlocked step
+        const float bankGain = gainSmoothed.getNextValue();
+        const float bankPan = panSmoothed.getNextValue();
+
+        const float gain = adsr.getNextSample() * voiceVelocity * (voiceGainLocked ? voiceGain : bankGain);
+        const float panningVal = juce::jlimit(-1.0f, 1.0f, (voicePanLocked ? voicePan : bankPan) + panOffsets[i]);
+
+        const float leftGain = panningVal <= 0.0f ? 1.0f : 1.0f - panningVal; // more pan to the right, lower the left gain
+        const float rightGain = panningVal >= 0.0f ? 1.0f : 1.0f + panningVal;
+
+        float left, right;
+
+        if constexpr (interpolationType == Interpolation::hermite)
+        {
+            left = hermiteInterpolate(sourceLeft, index, fraction);
+            right = hermiteInterpolate(sourceRight, index, fraction);
+        }else
+        {
+            //linear interpolation, the buffer is padded so index + 1 is always valid
+            left = sourceLeft[index] + fraction * (sourceLeft[index + 1] - sourceLeft[index]);
+            right = sourceRight[index] + fraction * (sourceRight[index + 1] - sourceRight[index]);
+        }
+
+        if(outputRight != nullptr)
+        {
+            lastLeft = left * gain * leftGain;
+            lastRight = right * gain * rightGain;
+            outputLeft[i] += lastLeft;
+            outputRight[i] += lastRight;
+        }else
+        {
+            lastLeft = 0.5f * (left + right) * gain;
+            outputLeft[i] += lastLeft;
+        }
+
+        readPosition += baseIncrement * voicePitchRatio * pitchRatios[i] * speedSmoothed.getNextValue() * voiceDirection;
+    }
+
+    lastOutputLeft = lastLeft;
+    lastOutputRight = lastRight;
+}
+
+void Bank::renderGranular(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    //the scan follows the bank's speed like a normal voice, the matrix's pitch only transposes the grains
+    const double baseIncrement = voiceSample->getSampleRate() / currentSampleRate;
+    const double scanIncrement = baseIncrement * voicePitchRatio * speedSmoothed.skip(numSamples);
+
+    granular.process(*voiceSample, numSamples, scanIncrement, modulation.getPitchRatios());
+    readPosition = juce::jmin(granular.getPlayhead(), static_cast<double>(voiceEndSample));
+
+    const int numOutputChannels = juce::jmin(outputBuffer.getNumChannels(), 2);
+    float* outputLeft = outputBuffer.getWritePointer(0, startSample);
+    float* outputRight = numOutputChannels > 1 ? outputBuffer.getWritePointer(1, startSample) : nullptr;
+
+    const float* grainsLeft = granular.getOutput(0);
+    const float* grainsRight = granular.getOutput(1);
+    const float* panOffsets = modulation.getPanOffsets();
+
+    float lastLeft = lastOutputLeft, lastRight = lastOutputRight;
+
+    //the same envelope, gain and pan as a normal voice, on the grains' mix
+    for(int i = 0; i < numSamples; i++)
+    {
+        if(!adsr.isActive())
+        {
+            endVoice();
+            return;
+        }
+
+        const float bankGain = gainSmoothed.getNextValue();
+        const float bankPan = panSmoothed.getNextValue();
+
+        const float gain = adsr.getNextSample() * voiceVelocity * (voiceGainLocked ? voiceGain : bankGain);
+        const float panningVal = juce::jlimit(-1.0f, 1.0f, (voicePanLocked ? voicePan : bankPan) + panOffsets[i]);
+
+        if(outputRight != nullptr)
+        {
+            lastLeft = grainsLeft[i] * gain * (panningVal <= 0.0f ? 1.0f : 1.0f - panningVal);
+            lastRight = grainsRight[i] * gain * (panningVal >= 0.0f ? 1.0f : 1.0f + panningVal);
+            outputLeft[i] += lastLeft;
+            outputRight[i] += lastRight;
+        }else
+        {
+            lastLeft = 0.5f * (grainsLeft[i] + grainsRight[i]) * gain;
+            outputLeft[i] += lastLeft;
+        }
+    }
+
+    lastOutputLeft = lastLeft;
+    lastOutputRight = lastRight;
+
+    if(!granular.isPlaying()) //scanned to the end and the last grain has finished
+    {
+        endVoice();
+    }
+}
+
+bool Bank::reachedBoundary()
+{
+    if(playMode != PlayMode::pingPong || voiceTurnedRound || isListenerBank)
+    {
+        return false;
+    }
+
+    //reflect whatever went past the end back inside the region, then read down to the start
+    readPosition = juce::jmax(static_cast<double>(voiceStartSample), 2.0 * voiceBoundary - readPosition);
+    voiceBoundary = voiceStartSample;
+    voiceDirection = -1.0;
+    voiceTurnedRound = true;
+    return readPosition > voiceBoundary;
+}
+
+void Bank::handlePendingRequests()
+{
+    const double requestedPosition = positionRequested.exchange(-1.0);
+
+    if(requestedPosition >= 0.0)
+    {
+        readPosition = requestedPosition * sample->getSampleRate();
+    }
+
+    if(stopRequested.exchange(false))
+    {
+        noteOff();
+    }
+
+    if(playRequested.exchange(false))
+    {
+        startVoice(1.0f, {});
+    }
+}
+
+void Bank::startVoice(float velocity, const StepLocks& locks)
+{
+    if(!voiceActive)
+    {
+        //idle banks aren't rendered, so the smoothers haven't moved since the last note
+        gainSmoothed.setCurrentAndTargetValue(gainSmoothed.getTargetValue());
+        panSmoothed.setCurrentAndTargetValue(panSmoothed.getTargetValue());
+        speedSmoothed.setCurrentAndTargetValue(speedSmoothed.getTargetValue());
+        effects.reset(); //no tail left over from the last note
+    }else
+    {
+        //whatever the old note and any declick still running were putting out, ramped away under the new note
+        const float remaining = static_cast<float>(declickSamplesLeft) / static_cast<float>(declickLength);
+        declickLeft = lastOutputLeft + declickLeft * remaining;
+        declickRight = lastOutputRight + declickRight * remaining;
+        declickSamplesLeft = declickLength;
     }
-    
-    if(!paused)
+
+    lastOutputLeft = 0.0f;
+    lastOutputRight = 0.0f;
+
+    voiceSample = sample.get();
+    voiceDirection = 1.0;
+    voiceTurnedRound = false;
+    voiceGranular = playMode == PlayMode::granular && !isListenerBank;
+    modulation.noteOn(velocity);
+
+    if(isListenerBank)
+    {
+        voiceStartSample = 0;
+        voiceEndSample = sample->getNumSamples(); //plays to the end of the file from wherever the playhead is
+
+        if(readPosition >= voiceEndSample)
+        {
+            readPosition = 0;
+        }
+    }else
     {
-        if(!readerSource.get())
+        auto l = chooseRegion(velocity);
+
+        if(!l.proper())
         {
-            bufferToFill.clearActiveBufferRegion();
+            voiceActive = false;
             return;
         }
-        
-        
-        resampleSource.getNextAudioBlock(bufferToFill);
-        applyPan(bufferToFill, panPosition);
-        
-        
-        if(adsr.isActive())
-        
+
+        const float offset = (locks.isLocked(StepLocks::startOffsetLocked) ? locks.startOffset : startOffset) + modulation.getNoteStartOffset();
+
+        voiceStartSample = static_cast<int>(l.start() * sample->getNumSamples());
+        voiceEndSample = juce::jmin(static_cast<int>(l.end() * sample->getNumSamples()), sample->getNumSamples());
+        voiceRegion = l;
+
+        const double offsetSamples = juce::jlimit(0.0f, 1.0f, offset) * (voiceEndSample - voiceStartSample);
+
+        if(playMode == PlayMode::reverse)
         {
-            adsr.applyEnvelopeToBuffer(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
-           
-            
+            //from the last sample of the region down to its start, no reversed copy of the sample is made
+            readPosition = voiceEndSample - 1 - offsetSamples;
+            voiceDirection = -1.0;
+        }else
+        {
+            readPosition = voiceStartSample + offsetSamples;
         }
-        
+    }
+
+    voiceEndSample = juce::jmin(voiceEndSample, sample->getNumSamples());
+    voiceBoundary = voiceDirection > 0.0 ? voiceEndSample : voiceStartSample;
+
+    if(voiceGranular)
+    {
+        granular.start(readPosition, voiceStartSample, voiceEndSample);
+    }
+    voiceVelocity = velocity;
+    voiceActive = true;
+
+    voicePitchRatio = locks.isLocked(StepLocks::pitchLocked) ? std::exp2(locks.pitch / 12.0) : 1.0;
+    voiceGainLocked = locks.isLocked(StepLocks::gainLocked);
+    voiceGain = locks.gain;
+    voicePanLocked = locks.isLocked(StepLocks::panLocked);
+    voicePan = locks.pan;
+
+    //envelope locks last until the next note, which goes back to the bank's own settings
+    auto voiceAdsrParams = adsrParams;
+
+    if(locks.isLocked(StepLocks::attackLocked))
+    {
+        voiceAdsrParams.attack = locks.attack;
+    }
+
+    if(locks.isLocked(StepLocks::releaseLocked))
+    {
+        voiceAdsrParams.release = locks.release;
+    }
+
+    adsr.setParameters(voiceAdsrParams);
+    adsr.reset();
+    adsr.noteOn();
+}
+
+Interval<float> Bank::chooseRegion(float velocity)
+{
+    if(sliceVariants == nullptr)
+    {
+        return loopRegion;
+    }
+
+    const auto& candidates = sliceVariants->getCandidates(velocity);
+
+    if(candidates.count == 0)
+    {
+        return loopRegion;
+    }
+
+    int choice = 0;
+
+    if(sliceVariants->getPolicy() == SliceVariants::Policy::roundRobin)
+    {
+        auto& position = roundRobinPositions[candidates.layer];
+        choice = position < candidates.count ? position : 0; //the table may have shrunk since the last note
+        position = static_cast<juce::uint8>(choice + 1 < candidates.count ? choice + 1 : 0);
     }else
     {
-        bufferToFill.clearActiveBufferRegion();
+        choice = variantRandom.nextInt(candidates.count);
     }
+
+    return sliceVariants->getRegion(candidates, choice);
 }
 
 void Bank::releaseResources()
 {
-    transportSource.releaseResources();
-    resampleSource.releaseResources();
+    adsr.reset();
+    voiceActive = false;
+    declickSamplesLeft = 0;
 }
 
 bool Bank::loadURL(const juce::URL& url)
 {
-    
-    auto * reader = formatManager.createReaderFor(url.getLocalFile());
-    
-    if(reader)
-    {
-        
-        std::unique_ptr <juce::AudioFormatReaderSource > newSource(new juce::AudioFormatReaderSource(reader , true));
-        
-        transportSource.setSource(newSource.get(), 0, nullptr , reader ->sampleRate);
-        
-        readerSource.reset(newSource.release());
-   
-        fileLoaded = true;
-        
+
+    auto newSample = SampleBuffer::loadFromFile(formatManager, url.getLocalFile());
+
+    if(newSample != nullptr)
+    {
+        setSample(newSample);
         return true;
     }
     return false;
 }
 
-void Bank::play()
+void Bank::setSample(SampleBuffer::Ptr newSample)
 {
-    if(isListenerBank)
-    {
-        DBG("start listener");
-        adsr.reset();
-        adsr.noteOn();
-        transportSource.start();
-    }else
+    SampleBuffer::Ptr released;
+
     {
-        if(!isListenerBank && loopRegion.proper())
+        const juce::SpinLock::ScopedLockType lock(sampleLock);
+        std::swap(sample, newSample);
+
+        if(voiceActive && sample != nullptr)
         {
-            DBG("start loop");
-            adsr.reset();
-            adsr.noteOn();
-            
-            transportSource.setPosition(loopRegion.start());
-            transportSource.start();
+            //a sounding voice plays out on the buffer it started with, which is kept until the next swap
+            if(retiredSample.get() != voiceSample)
+            {
+                released = retiredSample;
+                retiredSample = newSample;
+            }
         }else
         {
-            transportSource.stop();
+            voiceActive = false;
+            voiceSample = sample.get();
+            readPosition = 0;
+            released = retiredSample;
+            retiredSample = nullptr;
         }
     }
-        
-        paused = false;
-    
+
+    //old samples are released here, on the message thread, once the lock is dropped
+    fileLoaded = sample != nullptr;
+    positionRelative = 0.0f;
 }
+
+void Bank::play()
+{
+    playRequested = true;
+}
+
 void Bank::stop()
 {
+    stopRequested = true;
+}
 
-    transportSource.stop();
- 
+void Bank::noteOn(float velocity, const StepLocks& locks)
+{
+    if(velocity <= 0.0f) //a silent voice would be rendered for nothing
+    {
+        noteOff();
+        return;
+    }
+
+    const juce::SpinLock::ScopedTryLockType lock(sampleLock);
+
+    if(lock.isLocked() && sample != nullptr)
+    {
+        startVoice(velocity, locks);
+    }
+}
+
+void Bank::noteOff()
+{
+    if(voiceActive)
+    {
+        adsr.noteOff();
+    }
+}
+
+void Bank::choke()
+{
+    if(voiceActive)
+    {
+        //a release from wherever the envelope is, the next note puts the bank's own release back
+        auto fastRelease = adsr.getParameters();
+        fastRelease.release = chokeReleaseSeconds;
+        adsr.setParameters(fastRelease);
+        adsr.noteOff();
+    }
 }
 
 
 void Bank::setPosition(double posInSecs)
 {
-    if(posInSecs < 0. || posInSecs > transportSource.getLengthInSeconds())
+    if(sample == nullptr || posInSecs < 0. || posInSecs > sample->getLengthInSeconds())
     {
         DBG("Set position incorrect");
         return;
     }
-    
-    transportSource.setPosition(posInSecs);
-    
-    if(transportSource.isPlaying() == true)
-    {
-        transportSource.start();
-    }
-    
+
+    positionRequested = posInSecs;
+    positionRelative = static_cast<float>(posInSecs / sample->getLengthInSeconds()); //so the playhead moves straight away
+
 }
 void Bank::setGain(double gain)
 {
-    float volume = gain / 5;
-    transportSource.setGain(volume);
+    gainSmoothed.setTargetValue(static_cast<float>(gain));
 }
 
 bool Bank::isURLLoaded()
@@ -183,23 +636,25 @@ bool Bank::isURLLoaded()
     return fileLoaded;
 }
 
+bool Bank::isActive() const
+{
+    return voiceActive || playRequested.load() || declickSamplesLeft > 0;
+}
+
 float Bank::getPositionRelative()
 {
-    auto length = transportSource.getLengthInSeconds();
-    
-    if(length > 0.f)
-    {
-        return transportSource.getCurrentPosition() / length;
-    }else
-    {
-        return 0.f;
-    }
+    return positionRelative;
 }
 
 void Bank::setPositionRelative(const double pos)
 {
-    auto posInSecs = pos * transportSource.getLengthInSeconds();
-    
+    if(sample == nullptr)
+    {
+        return;
+    }
+
+    auto posInSecs = pos * sample->getLengthInSeconds();
+
     setPosition(posInSecs);
 }
 
@@ -207,20 +662,26 @@ void Bank::setLoopRegion(float start, float end)
 {
         loopRegion.start(start); //between 0-1
         loopRegion.end(end);
-        
+
     if(!loopRegion.proper())
         {
-            //not stopping transport source due to the overhead
             DBG("loop stopped");
-            setPosition(transportSource.getLengthInSeconds());
+            stop();
         }
-    
+
 }
 
 void Bank::setAdsrParameters(juce::ADSR::Parameters myParams)
 {
-    
-    adsr.setParameters(myParams);
+    //called every block, only recalculate the envelope rates when something moved
+    if(myParams.attack == adsrParams.attack && myParams.decay == adsrParams.decay
+       && myParams.sustain == adsrParams.sustain && myParams.release == adsrParams.release)
+    {
+        return;
+    }
+
+    adsrParams = myParams;
+    adsr.setParameters(adsrParams);
 }
 
 juce::ADSR::Parameters* Bank::getAdsrParameters() //returning address
@@ -240,28 +701,45 @@ bool Bank::getAdsrDisplay()
 
 void Bank::setPanning(float panValue)
 {
-    panPosition = panValue;
-    DBG("Pan position = " << panPosition);
+    panSmoothed.setTargetValue(panValue);
 }
 
-void Bank::applyPan(const juce::AudioSourceChannelInfo &bufferToFill, float panningVal)
+void Bank::setSpeed(float speed)
+{
+    speedSmoothed.setTargetValue(speed);
+}
+
+void Bank::setPlayMode(PlayMode newPlayMode)
+{
+    playMode = newPlayMode;
+}
+
+void Bank::setStartOffset(float newStartOffset)
+{
+    startOffset = newStartOffset;
+}
+
+void Bank::setInterpolation(Interpolation newInterpolation)
+{
+    interpolation = newInterpolation;
+}
+
+SampleBuffer::Ptr Bank::getSample() const
+{
+    return sample; //only replaced by setSample, which is also on the message thread
+}
+
+void Bank::setSliceVariants(SliceVariants::Ptr newVariants)
 {
-    if(bufferToFill.buffer->getNumChannels() < 2) return;
-    
-    auto* leftChannel = bufferToFill.buffer->getWritePointer(0, bufferToFill.startSample);
-    auto* rightChannel = bufferToFill.buffer->getWritePointer(1, bufferToFill.startSample);
-    
-    const float leftGain = panningVal <= 0.0f ? 1.0f : 1.0f - panningVal; // more pan to the right, lower the left gain
-    const float rightGain = panningVal >= 0.0f ? 1.0f : 1.0f + panningVal;
-    
-    for(int sample = 0; sample < bufferToFill.numSamples; sample++)
     {
-        leftChannel[sample] *= leftGain;
-        rightChannel[sample] *= rightGain;
+        const juce::SpinLock::ScopedLockType lock(sampleLock);
+        std::swap(sliceVariants, newVariants);
     }
+
+    //the old table is released here, on the message thread, like an old sample
 }
-void Bank::setSpeed(float speed)
+
+SliceVariants::Ptr Bank::getSliceVariants() const
 {
-    resampleSource.setResamplingRatio(speed);
+    return sliceVariants; //only replaced by setSliceVariants, on the message thread
 }
-
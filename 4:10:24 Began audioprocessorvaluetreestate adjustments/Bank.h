@@ -12,6 +12,79 @@
 
 #include <JuceHeader.h>
 #include "Interval.h"
+#include "SampleBuffer.h"
+#include "BankEffects.h"
+#include "SliceVariants.h"
+#include "ModulationMatrix.h"
+#include "GranularEngine.h"
+
+//per-step overrides from the sequencer, applied when the step triggers the bank.
+//packed into one 64 bit word so a pattern can hold them as atomics
+struct StepLocks
+{
+    enum Flags : juce::uint32
+    {
+        startOffsetLocked = 1 << 0,
+        pitchLocked = 1 << 1,
+        panLocked = 1 << 2,
+        gainLocked = 1 << 3,
+        attackLocked = 1 << 4,
+        releaseLocked = 1 << 5
+    };
+
+    juce::uint32 flags = 0;
+    float startOffset = 0.0f; //0-1 through the loop region
+    float pitch = 0.0f; //semitones, quarter semitone steps between -24 and 24
+    float pan = 0.0f; //-1 - 1
+    float gain = 1.0f; //0 - 1
+    float attack = 0.1f; //seconds, 10ms steps up to 2.55
+    float release = 0.2f; //seconds, 20ms steps up to 5.1
+
+    bool isLocked(Flags flag) const { return (flags & flag) != 0; }
+
+    juce::uint64 pack() const
+    {
+        auto field = [](float value, float scale, int low, int high)
+        {
+            return static_cast<juce::uint64>(static_cast<juce::uint8>(juce::jlimit(low, high, juce::roundToInt(value * scale))));
+        };
+
+        return static_cast<juce::uint64>(flags & 0x3f)
+             | (static_cast<juce::uint64>(juce::jlimit(0, 1023, juce::roundToInt(startOffset * 1023.0f))) << 6)
+             | (field(pitch, 4.0f, -96, 96) << 16)
+             | (field(pan, 127.0f, -127, 127) << 24)
+             | (field(gain, 255.0f, 0, 255) << 32)
+             | (field(attack, 100.0f, 0, 255) << 40)
+             | (field(release, 50.0f, 0, 255) << 48);
+    }
+
+    static StepLocks unpack(juce::uint64 word)
+    {
+        auto field = [word](int shift) { return static_cast<juce::uint8>((word >> shift) & 0xff); };
+
+        StepLocks locks;
+        locks.flags = static_cast<juce::uint32>(word & 0x3f);
+        locks.startOffset = static_cast<float>((word >> 6) & 0x3ff) / 1023.0f;
+        locks.pitch = static_cast<juce::int8>(field(16)) / 4.0f;
+        locks.pan = static_cast<juce::int8>(field(24)) / 127.0f;
+        locks.gain = field(32) / 255.0f;
+        locks.attack = field(40) / 100.0f;
+        locks.release = field(48) / 50.0f;
+        return locks;
+    }
+};
+
+//a note for one of the banks at a sample offset inside the current block, from MIDI or the sequencer
+struct BankEvent
+{
+    enum class Type { noteOn, noteOff, allNotesOff };
+
+    int samplePosition = 0;
+    int bankIndex = 0;
+    Type type = Type::noteOn;
+    float velocity = 1.0f;
+    StepLocks locks; //only set by the sequencer
+};
 
 class Bank : public juce::AudioSource
 {
@@ -19,15 +92,25 @@ public:
     Bank(juce::AudioFormatManager& afm);
     ~Bank();
     bool loadURL(const juce::URL& url);
-    void play(); void stop();
-    void setPosition(double posInSecs); 
+    void setSample(SampleBuffer::Ptr newSample); //shares an already decoded file with this bank, a sounding note finishes on the old one
+    void play(); void stop(); //message thread, picked up at the start of the next rendered block
+    void noteOn(float velocity, const StepLocks& locks = {}); void noteOff(); //audio thread, takes effect at the next rendered sample
+    void choke(); //audio thread, another bank in the choke group was hit, fades out over chokeReleaseSeconds
+    static constexpr float chokeReleaseSeconds = 0.005f; //long enough not to click
+    static constexpr float retriggerDeclickSeconds = chokeReleaseSeconds; //see renderDeclick
+    void setPosition(double posInSecs);
     void setPositionRelative(const double pos);
     void setGain(double gain);
-    
+
     void prepareToPlay(int samplesPerBlockExpected , double sampleRate) override;
     void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
     void releaseResources() override;
+
+    //adds this bank's voice into the buffer, the processor splits blocks at MIDI events so notes start on the exact sample
+    void renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
+
     bool isURLLoaded();
+    bool isActive() const; //audio thread, false once the voice has stopped or released, so the processor can skip the bank
     float getPositionRelative();
     void setLoopRegion(float start, float end);
     void setAdsrParameters(juce::ADSR::Parameters myParams);
@@ -35,36 +118,127 @@ public:
     void setAdsrDisplay(bool state);
     bool getAdsrDisplay();
     void setPanning(float panValue);
-    void applyPan(const juce::AudioSourceChannelInfo& bufferToFill, float panningVal);
     void makeBankListener(bool listenerBank)
     {
         isListenerBank = listenerBank;
     }
     void setSpeed(float speed);
-    
 
-    
+    //how a note plays its region, reverse and ping pong read the same sample memory backwards,
+    //granular plays it as overlapping grains from a playhead moving through it
+    enum class PlayMode { forward, reverse, pingPong, granular };
+
+    //audio thread, set once per block by the processor and picked up by the next note
+    void setPlayMode(PlayMode newPlayMode);
+    void setStartOffset(float newStartOffset); //0-1 through the region, a step's start offset lock replaces it
+
+    //linear for playback, the offline renderer switches to 4 point hermite
+    enum class Interpolation { linear, hermite };
+    void setInterpolation(Interpolation newInterpolation);
+
+    //insert effects on this bank's voice, audio thread, the processor sets them once per block
+    void setEffectParameters(const BankEffects::Parameters& parameters);
+
+    //LFO, envelope, velocity and random routings for this bank's voice, audio thread, once per block
+    void setModulationParameters(const ModulationMatrix::Parameters& parameters);
+
+    //grain density, size, spray and pitch for the granular play mode, audio thread, once per block
+    void setGranularParameters(const GranularEngine::Parameters& parameters);
+
+    SampleBuffer::Ptr getSample() const; //message thread
+
+    //variants picked by velocity and round robin or at random in place of the loop region, nullptr for the loop region
+    void setSliceVariants(SliceVariants::Ptr newVariants); //message thread
+    SliceVariants::Ptr getSliceVariants() const;
+
     Interval<float> loopRegion;
-    
-    
+
+
     private:
-    
+
+    void startVoice(float velocity, const StepLocks& locks);
+    Interval<float> chooseRegion(float velocity); //the loop region, or a variant when there are any
+
+    //the per sample loop, one copy per interpolation so the choice isn't made every sample
+    template <Interpolation interpolationType>
+    void renderVoice(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
+    void renderVoice(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples, Interpolation interpolationType);
+    void processEffects(int numSamples); //on effectsBuffer, following the modulated cutoff when there is one
+    void renderGranular(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
+    void endVoice();
+
+    //a note retriggered while the last one is sounding starts from silence, the old note's last output is
+    //ramped down to nothing under it over retriggerDeclickSeconds so the jump doesn't click
+    void renderDeclick(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
+    void handlePendingRequests();
+    bool reachedBoundary(); //a ping pong voice turns round, anything else ends, returns false once it has ended
+
     juce::AudioFormatManager& formatManager;
     juce::ADSR adsr;
     juce::ADSR::Parameters adsrParams;
-    
-    bool paused;
-    bool fileLoaded = false;
-    std::unique_ptr <juce::AudioFormatReaderSource > readerSource;
-    juce::ResamplingAudioSource resampleSource{&transportSource, false, 2};
-    juce::AudioTransportSource transportSource;
-    
+
+    //the decoded file, swapped under the lock so the audio thread never sees a half replaced sample
+    SampleBuffer::Ptr sample;
+    juce::SpinLock sampleLock;
+
+    //what the voice is reading, sample or, when it was swapped mid note, retiredSample until the note ends
+    const SampleBuffer* voiceSample = nullptr;
+    SampleBuffer::Ptr retiredSample;
+    std::atomic<bool> fileLoaded {false};
+
+    //swapped under sampleLock too, the round robin positions are the audio thread's own
+    SliceVariants::Ptr sliceVariants;
+    std::array<juce::uint8, SliceVariants::numberOfLayers> roundRobinPositions {};
+    juce::Random variantRandom;
+
+    double currentSampleRate = 44100.0;
+
+    //voice state, only touched on the audio thread
+    bool voiceActive = false;
+    Interval<float> voiceRegion; //the loop region or variant the voice is playing
+    double readPosition = 0; //in samples of the source file
+    int voiceEndSample = 0;
+    int voiceStartSample = 0;
+    double voiceDirection = 1.0; //-1 while reading backwards
+    double voiceBoundary = 0.0; //where the voice turns round or stops, the end going forwards and the start going backwards
+    bool voiceTurnedRound = false; //ping pong only turns once, then plays back down to the start
+    bool voiceGranular = false; //fixed when the note starts, the play mode can change under it
+    PlayMode playMode = PlayMode::forward;
+    float startOffset = 0.0f;
+    float voiceVelocity = 1.0f;
+    double voicePitchRatio = 1.0; //from a pitch lock, on top of the bank's speed
+    bool voiceGainLocked = false, voicePanLocked = false;
+    float voiceGain = 1.0f, voicePan = 0.0f;
+    float lastOutputLeft = 0.0f, lastOutputRight = 0.0f; //the voice's last sample before effects, left only into a mono output
+    float declickLeft = 0.0f, declickRight = 0.0f;
+    int declickSamplesLeft = 0;
+    int declickLength = 1;
+
+    //requests from the GUI, handled on the audio thread
+    std::atomic<bool> playRequested {false};
+    std::atomic<bool> stopRequested {false};
+    std::atomic<double> positionRequested {-1.0};
+
+    std::atomic<float> positionRelative {0.0f}; //for the playheads
+
     bool isListenerBank = false;
-    
-    float panPosition = 0;
-    
+    std::atomic<Interpolation> interpolation {Interpolation::linear};
+
+    //the voice is rendered into effectsBuffer and processed there when any effect is on, sized in prepareToPlay
+    BankEffects effects;
+    juce::AudioBuffer<float> effectsBuffer;
+
+    //worked out a block at a time before the voice is rendered, the same size as effectsBuffer
+    ModulationMatrix modulation;
+    GranularEngine granular;
+
+    //targets are set once per block by the processor, read per sample while rendering
+    juce::SmoothedValue<float> gainSmoothed{1.0f};
+    juce::SmoothedValue<float> panSmoothed{0.0f};
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> speedSmoothed{1.0f};
+
     bool adsrDisplayToggle = true;
-    
+
     float localFineTune;
-    
+
 };
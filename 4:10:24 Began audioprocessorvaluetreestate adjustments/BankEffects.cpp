@@ -0,0 +1,320 @@
+/*
+  ==============================================================================
+
+    BankEffects.cpp
+    Created: 13 Oct 2024 2:15:40pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "BankEffects.h"
+
+//one pole smoothing coefficient for a time constant
+static float onePoleCoefficient(double seconds, double sampleRate)
+{
+    return static_cast<float>(1.0 - std::exp(-1.0 / (seconds * sampleRate)));
+}
+
+void BankEffects::prepare(double sampleRate, int maximumBlockSize)
+{
+    chain.prepare({sampleRate, static_cast<juce::uint32>(maximumBlockSize), 2});
+}
+
+void BankEffects::reset()
+{
+    chain.reset();
+}
+
+void BankEffects::setParameters(const Parameters& newParameters)
+{
+    chain.setBypassed<filterIndex>(!newParameters.filterEnabled);
+    chain.setBypassed<driveIndex>(!newParameters.driveEnabled);
+    chain.setBypassed<crushIndex>(!newParameters.crushEnabled);
+    chain.setBypassed<shaperIndex>(!newParameters.shaperEnabled);
+
+    enabled = newParameters.filterEnabled || newParameters.driveEnabled || newParameters.crushEnabled || newParameters.shaperEnabled;
+
+    if(newParameters.filterEnabled)
+    {
+        chain.get<filterIndex>().setParameters(newParameters.filterType, newParameters.cutoff, newParameters.resonance, newParameters.envelopeAmount);
+    }
+
+    if(newParameters.driveEnabled)
+    {
+        chain.get<driveIndex>().setDrive(newParameters.drive);
+    }
+
+    if(newParameters.crushEnabled)
+    {
+        chain.get<crushIndex>().setParameters(newParameters.bitDepth, newParameters.downsample);
+    }
+
+    if(newParameters.shaperEnabled)
+    {
+        chain.get<shaperIndex>().setParameters(newParameters.shaperAttack, newParameters.shaperSustain);
+    }
+}
+
+bool BankEffects::isEnabled() const
+{
+    return enabled;
+}
+
+void BankEffects::setCutoffModulation(float octaves)
+{
+    chain.get<filterIndex>().setCutoffModulation(octaves);
+}
+
+void BankEffects::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const auto numChannels = static_cast<size_t>(juce::jmin(buffer.getNumChannels(), 2));
+    auto block = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock(0, numChannels)
+                                                    .getSubBlock(static_cast<size_t>(startSample), static_cast<size_t>(numSamples));
+
+    chain.process(juce::dsp::ProcessContextReplacing<float>(block));
+}
+
+//==============================================================================
+void BankEffects::EnvelopeFilter::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    filter.prepare(spec);
+    maximumCutoff = static_cast<float>(spec.sampleRate * 0.49);
+    envelopeRelease = std::exp(-static_cast<float>(controlInterval / (0.15 * spec.sampleRate))); //150ms fall
+    currentCutoff = 0.0f;
+    currentResonance = 0.0f;
+    envelope = 0.0f;
+}
+
+void BankEffects::EnvelopeFilter::reset()
+{
+    filter.reset();
+    envelope = 0.0f;
+}
+
+void BankEffects::EnvelopeFilter::setParameters(FilterType type, float cutoff, float resonance, float envelopeAmount)
+{
+    switch(type)
+    {
+        case FilterType::lowpass: filter.setType(juce::dsp::StateVariableTPTFilterType::lowpass); break;
+        case FilterType::bandpass: filter.setType(juce::dsp::StateVariableTPTFilterType::bandpass); break;
+        case FilterType::highpass: filter.setType(juce::dsp::StateVariableTPTFilterType::highpass); break;
+    }
+
+    baseCutoff = cutoff;
+    amount = envelopeAmount;
+
+    //both recalculate the coefficients, so only when they've moved
+    if(resonance != currentResonance)
+    {
+        currentResonance = resonance;
+        filter.setResonance(resonance);
+    }
+
+}
+
+void BankEffects::EnvelopeFilter::setCutoffModulation(float octaves)
+{
+    modulationOctaves = octaves;
+}
+
+void BankEffects::EnvelopeFilter::process(const juce::dsp::ProcessContextReplacing<float>& context)
+{
+    if(context.isBypassed)
+    {
+        return;
+    }
+
+    auto& block = context.getOutputBlock();
+    const auto numSamples = block.getNumSamples();
+
+    if(amount == 0.0f)
+    {
+        const float cutoff = modulationOctaves == 0.0f ? juce::jmin(baseCutoff, maximumCutoff)
+                                                       : juce::jlimit(20.0f, maximumCutoff, baseCutoff * std::exp2(modulationOctaves));
+
+        if(cutoff != currentCutoff) //recalculates the coefficients, so only when it's moved
+        {
+            currentCutoff = cutoff;
+            filter.setCutoffFrequency(cutoff);
+        }
+
+        filter.process(context);
+        return;
+    }
+
+    //the cutoff moves at control rate, the filter still runs every sample
+    for(size_t position = 0; position < numSamples; position += controlInterval)
+    {
+        auto subBlock = block.getSubBlock(position, juce::jmin(static_cast<size_t>(controlInterval), numSamples - position));
+
+        float peak = 0.0f;
+        for(size_t channel = 0; channel < subBlock.getNumChannels(); channel++)
+        {
+            const float* data = subBlock.getChannelPointer(channel);
+
+            for(size_t i = 0; i < subBlock.getNumSamples(); i++)
+            {
+                peak = juce::jmax(peak, std::abs(data[i]));
+            }
+        }
+
+        envelope = peak > envelope ? peak : envelope * envelopeRelease;
+
+        const float cutoff = juce::jlimit(20.0f, maximumCutoff, baseCutoff * std::exp2(modulationOctaves + amount * 4.0f * juce::jmin(envelope, 1.0f)));
+
+        if(cutoff != currentCutoff)
+        {
+            currentCutoff = cutoff;
+            filter.setCutoffFrequency(cutoff);
+        }
+
+        filter.process(juce::dsp::ProcessContextReplacing<float>(subBlock));
+    }
+}
+
+//==============================================================================
+void BankEffects::Drive::setDrive(float driveInDecibels)
+{
+    inputGain = juce::Decibels::decibelsToGain(driveInDecibels);
+    makeupGain = 1.0f / std::tanh(inputGain);
+}
+
+void BankEffects::Drive::process(const juce::dsp::ProcessContextReplacing<float>& context)
+{
+    if(context.isBypassed)
+    {
+        return;
+    }
+
+    auto& block = context.getOutputBlock();
+
+    //no branches in the loop, so each channel vectorises
+    for(size_t channel = 0; channel < block.getNumChannels(); channel++)
+    {
+        float* data = block.getChannelPointer(channel);
+
+        for(size_t i = 0; i < block.getNumSamples(); i++)
+        {
+            //the approximation holds between -5 and 5, past that tanh is 1 anyway
+            const float x = juce::jlimit(-5.0f, 5.0f, data[i] * inputGain);
+            data[i] = juce::dsp::FastMathApproximations<float>::tanh(x) * makeupGain;
+        }
+    }
+}
+
+//==============================================================================
+void BankEffects::Bitcrusher::reset()
+{
+    holdCounter = 0;
+    heldSamples.fill(0.0f);
+}
+
+void BankEffects::Bitcrusher::setParameters(float bitDepth, int downsample)
+{
+    levels = std::exp2(juce::jlimit(1.0f, 16.0f, bitDepth) - 1.0f);
+    holdLength = juce::jmax(1, downsample);
+}
+
+void BankEffects::Bitcrusher::process(const juce::dsp::ProcessContextReplacing<float>& context)
+{
+    if(context.isBypassed)
+    {
+        return;
+    }
+
+    auto& block = context.getOutputBlock();
+    const size_t numChannels = juce::jmin(block.getNumChannels(), heldSamples.size());
+    const float stepsToLevel = 1.0f / levels;
+
+    if(holdLength == 1)
+    {
+        for(size_t channel = 0; channel < numChannels; channel++)
+        {
+            float* data = block.getChannelPointer(channel);
+
+            for(size_t i = 0; i < block.getNumSamples(); i++)
+            {
+                data[i] = std::floor(data[i] * levels + 0.5f) * stepsToLevel;
+            }
+        }
+
+        return;
+    }
+
+    //one counter for both channels so they stay in step
+    for(size_t i = 0; i < block.getNumSamples(); i++)
+    {
+        if(holdCounter == 0)
+        {
+            for(size_t channel = 0; channel < numChannels; channel++)
+            {
+                heldSamples[channel] = std::floor(block.getChannelPointer(channel)[i] * levels + 0.5f) * stepsToLevel;
+            }
+        }
+
+        for(size_t channel = 0; channel < numChannels; channel++)
+        {
+            block.getChannelPointer(channel)[i] = heldSamples[channel];
+        }
+
+        holdCounter = holdCounter + 1 < holdLength ? holdCounter + 1 : 0;
+    }
+}
+
+//==============================================================================
+void BankEffects::TransientShaper::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    fastAttackCoefficient = onePoleCoefficient(0.001, spec.sampleRate);
+    slowAttackCoefficient = onePoleCoefficient(0.02, spec.sampleRate);
+    releaseCoefficient = onePoleCoefficient(0.05, spec.sampleRate);
+    slowReleaseCoefficient = onePoleCoefficient(0.25, spec.sampleRate); //slow envelope stays above the fast one in the tail
+    reset();
+}
+
+void BankEffects::TransientShaper::reset()
+{
+    fastEnvelope = 0.0f;
+    slowEnvelope = 0.0f;
+}
+
+void BankEffects::TransientShaper::setParameters(float attackAmount, float sustainAmount)
+{
+    attack = attackAmount;
+    sustain = sustainAmount;
+}
+
+void BankEffects::TransientShaper::process(const juce::dsp::ProcessContextReplacing<float>& context)
+{
+    if(context.isBypassed)
+    {
+        return;
+    }
+
+    auto& block = context.getOutputBlock();
+    const size_t numChannels = block.getNumChannels();
+    constexpr float tiny = 1.0e-5f;
+
+    for(size_t i = 0; i < block.getNumSamples(); i++)
+    {
+        float level = 0.0f;
+        for(size_t channel = 0; channel < numChannels; channel++)
+        {
+            level = juce::jmax(level, std::abs(block.getChannelPointer(channel)[i]));
+        }
+
+        fastEnvelope += (level - fastEnvelope) * (level > fastEnvelope ? fastAttackCoefficient : releaseCoefficient);
+        slowEnvelope += (level - slowEnvelope) * (level > slowEnvelope ? slowAttackCoefficient : slowReleaseCoefficient);
+
+        //0 - 1 for how far into the attack or the tail this sample is
+        const float transient = juce::jlimit(0.0f, 1.0f, (fastEnvelope - slowEnvelope) / (fastEnvelope + tiny));
+        const float tail = juce::jlimit(0.0f, 1.0f, (slowEnvelope - fastEnvelope) / (slowEnvelope + tiny));
+
+        const float gain = juce::jlimit(0.0f, 4.0f, 1.0f + 2.0f * (attack * transient + sustain * tail));
+
+        for(size_t channel = 0; channel < numChannels; channel++)
+        {
+            block.getChannelPointer(channel)[i] *= gain;
+        }
+    }
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    BankEffects.h
+    Created: 13 Oct 2024 2:15:40pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//A bank's insert chain: filter, drive, bitcrusher and transient shaper, run in place on the bank's voice
+//before it's added to the mix. Each slot is a processor in a dsp::ProcessorChain, a slot that's switched
+//off is bypassed and returns straight away, and with every slot off the bank skips the chain entirely.
+class BankEffects
+{
+public:
+    enum class FilterType { lowpass, bandpass, highpass };
+
+    struct Parameters
+    {
+        bool filterEnabled = false;
+        FilterType filterType = FilterType::lowpass;
+        float cutoff = 5000.0f; //Hz
+        float resonance = 0.707f; //Q
+        float envelopeAmount = 0.0f; //-1 - 1, moves the cutoff up to 4 octaves with the voice's level
+
+        bool driveEnabled = false;
+        float drive = 12.0f; //dB into the saturator
+
+        bool crushEnabled = false;
+        float bitDepth = 8.0f;
+        int downsample = 1; //each output sample is held this many samples
+
+        bool shaperEnabled = false;
+        float shaperAttack = 0.0f; //-1 - 1, cuts or boosts the start of each hit
+        float shaperSustain = 0.0f; //-1 - 1, cuts or boosts the tail
+    };
+
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset();
+
+    //audio thread, once per block
+    void setParameters(const Parameters& newParameters);
+    bool isEnabled() const; //true when any slot is switched on
+
+    //audio thread, from the bank's modulation matrix, moves the filter's cutoff on top of its envelope
+    void setCutoffModulation(float octaves);
+
+    //up to two channels, processed in place
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    //state variable filter whose cutoff follows the level of the signal, updated every controlInterval samples
+    class EnvelopeFilter
+    {
+    public:
+        void prepare(const juce::dsp::ProcessSpec& spec);
+        void reset();
+        void setParameters(FilterType type, float cutoff, float resonance, float envelopeAmount);
+        void setCutoffModulation(float octaves);
+        void process(const juce::dsp::ProcessContextReplacing<float>& context);
+
+    private:
+        static constexpr int controlInterval = 32;
+
+        juce::dsp::StateVariableTPTFilter<float> filter;
+        float baseCutoff = 5000.0f;
+        float currentCutoff = 0.0f;
+        float currentResonance = 0.0f;
+        float amount = 0.0f;
+        float modulationOctaves = 0.0f;
+        float maximumCutoff = 20000.0f;
+        float envelope = 0.0f;
+        float envelopeRelease = 0.0f; //per control interval
+    };
+
+    //tanh saturation, normalised so a full scale peak stays at full scale
+    class Drive
+    {
+    public:
+        void prepare(const juce::dsp::ProcessSpec&) {}
+        void reset() {}
+        void setDrive(float driveInDecibels);
+        void process(const juce::dsp::ProcessContextReplacing<float>& context);
+
+    private:
+        float inputGain = 1.0f;
+        float makeupGain = 1.0f;
+    };
+
+    //quantises to a bit depth and holds samples to fake a lower sample rate
+    class Bitcrusher
+    {
+    public:
+        void prepare(const juce::dsp::ProcessSpec&) { reset(); }
+        void reset();
+        void setParameters(float bitDepth, int downsample);
+        void process(const juce::dsp::ProcessContextReplacing<float>& context);
+
+    private:
+        float levels = 128.0f;
+        int holdLength = 1;
+        int holdCounter = 0;
+        std::array<float, 2> heldSamples {};
+    };
+
+    //compares a fast and a slow envelope to find the start of each hit, then scales it and the tail separately
+    class TransientShaper
+    {
+    public:
+        void prepare(const juce::dsp::ProcessSpec& spec);
+        void reset();
+        void setParameters(float attackAmount, float sustainAmount);
+        void process(const juce::dsp::ProcessContextReplacing<float>& context);
+
+    private:
+        float attack = 0.0f, sustain = 0.0f;
+        float fastEnvelope = 0.0f, slowEnvelope = 0.0f;
+        float fastAttackCoefficient = 0.0f, slowAttackCoefficient = 0.0f, releaseCoefficient = 0.0f, slowReleaseCoefficient = 0.0f;
+    };
+
+private:
+    enum { filterIndex, driveIndex, crushIndex, shaperIndex };
+
+    juce::dsp::ProcessorChain<EnvelopeFilter, Drive, Bitcrusher, TransientShaper> chain;
+    bool enabled = false;
+};
@@ -10,9 +10,10 @@
 
 #include <JuceHeader.h>
 #include "BankGUI.h"
+#include "PluginProcessor.h"
 
 //==============================================================================
-BankGUI::BankGUI(Bank& bank) : bank(bank)
+BankGUI::BankGUI(Bank& bank, juce::AudioProcessorValueTreeState& apvts, int bankNumber) : bank(bank)
 {
     // In your constructor, you should add any child components, and
     // initialise any special settings that your component needs.
@@ -36,11 +37,9 @@ BankGUI::BankGUI(Bank& bank) : bank(bank)
     addAndMakeVisible(playButton);
     addAndMakeVisible(panningSlider);
     
-    panningSlider.addListener(this);
     panningSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
     
     addAndMakeVisible(pitchSlider);
-    pitchSlider.addListener(this);
     pitchSlider.setTextBoxStyle(juce::Slider::NoTextBox,false,0, 0);
     
     playButton.addListener(this);
@@ -51,7 +50,6 @@ BankGUI::BankGUI(Bank& bank) : bank(bank)
     for(int i = 0; i < sliders.size(); i++)
     {
         addAndMakeVisible(sliders[i]);
-        sliders[i]->addListener(this);
         sliders[i]->setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
     }
     
@@ -59,25 +57,28 @@ BankGUI::BankGUI(Bank& bank) : bank(bank)
     volumeSlider.setNumDecimalPlacesToDisplay(2);
     
     
-    juce::ADSR::Parameters* params = bank.getAdsrParameters();
+    panningSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+    //pitchSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
     
-    float attackVal = params->attack * 2;
-    float decayVal = params->decay * 2;
-    float sustainVal = params->sustain * 10;
+    //attachments set the ranges and values from the parameters
+    std::vector<std::pair<juce::Slider*, juce::String>> attachedSliders = {
+        {&volumeSlider, "Volume"}, {&attackSlider, "Attack"}, {&decaySlider, "Decay"},
+        {&sustainSlider, "Sustain"}, {&panningSlider, "Pan"}, {&pitchSlider, "Pitch"}};
     
-    attackSlider.setValue(attackVal);
-    decaySlider.setValue(decayVal);
-    sustainSlider.setValue(sustainVal);
+    for(auto& [slider, parameterName] : attachedSliders)
+    {
+        auto parameterID = SampleChopperAudioProcessor::getBankParameterID(bankNumber, parameterName);
+        sliderAttachments.push_back(std::make_unique<SliderAttachment>(apvts, parameterID, *slider));
+    }
     
-    attackSlider.setRange(0.f, 5.f);
-    decaySlider.setRange(0.f, 5.f);
+    //items in the same order as the choice parameter, the attachment selects by index
+    addAndMakeVisible(playModeSelector);
+    playModeSelector.addItemList({"Forward", "Reverse", "Ping Pong", "Granular"}, 1);
+    playModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, SampleChopperAudioProcessor::getBankParameterID(bankNumber, "PlayMode"), playModeSelector);
     
-    panningSlider.setRange(-1.f, 1.f);
-    panningSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
-    
-    pitchSlider.setRange(-0.1f, 0.1f);
-    pitchSlider.setValue(0);
-    //pitchSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+    addAndMakeVisible(chokeGroupSelector);
+    chokeGroupSelector.addItemList({"No Choke", "Choke 1", "Choke 2", "Choke 3", "Choke 4"}, 1);
+    chokeGroupAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, SampleChopperAudioProcessor::getBankParameterID(bankNumber, "ChokeGroup"), chokeGroupSelector);
     
 }
 
@@ -105,7 +106,9 @@ void BankGUI::resized()
    
     auto rowH = getHeight () / 10;
     
-    playButton.setBounds(0, 0, getWidth(), rowH);
+    playButton.setBounds(0, 0, getWidth() / 3, rowH);
+    playModeSelector.setBounds(getWidth() / 3, 0, getWidth() / 3, rowH);
+    chokeGroupSelector.setBounds((getWidth() / 3) * 2, 0, getWidth() - (getWidth() / 3) * 2, rowH);
     
     panningSlider.setBounds(0, rowH, getWidth(), rowH * 3);
     
@@ -137,63 +140,3 @@ void BankGUI::buttonClicked(juce::Button *button)
     }
 }
 
-void BankGUI::sliderValueChanged(juce::Slider *slider)
-{
-    
-    
-    juce::ADSR::Parameters* adsrParams = bank.getAdsrParameters();
-    
-    if(&volumeSlider == slider)
-    {
-        float volume = slider->getValue() / 10;
-        bank.setGain(volume);
-        
-    }
-    
-    //ADSR
-    if(&attackSlider == slider) // slider val is 0-10
-    {
-        
-        float attack = attackSlider.getValue() / 2;
-        adsrParams->attack = attack;
-        
-        bank.setAdsrParameters(*adsrParams);
-        
-        //DBG("attack  : "  << attack);
-        
-    }
-    if(&decaySlider == slider)
-    {
-        
-        float decay = decaySlider.getValue() / 2;
-        
-        adsrParams->decay = decay;
-        
-        bank.setAdsrParameters(*adsrParams);
-        
-        DBG("decay  : "  << decay);
-    }
-    if(&sustainSlider == slider)
-    {
-        
-        float sustain = sustainSlider.getValue() / 10; //between 0-1
-        
-        adsrParams->sustain = sustain;
-        
-        bank.setAdsrParameters(*adsrParams);
-        
-        DBG("sustain  : "  << sustain);
-    }
-    
-    if(&panningSlider == slider)
-    {
-        bank.setPanning(panningSlider.getValue());
-    }
-    
-    if(&pitchSlider == slider)
-    {
-        
-    }
-}
-
-
@@ -16,16 +16,15 @@
 //==============================================================================
 /*
 */
-class BankGUI  : public juce::Component, public juce::Button::Listener, public juce::Slider::Listener
+class BankGUI  : public juce::Component, public juce::Button::Listener
 {
 public:
-    BankGUI(Bank& bank);
+    BankGUI(Bank& bank, juce::AudioProcessorValueTreeState& apvts, int bankNumber);
     ~BankGUI() override;
 
     void paint (juce::Graphics&) override;
     void resized() override;
     void buttonClicked(juce::Button *button) override;
-    void sliderValueChanged(juce::Slider *slider) override;
     
    
     
@@ -47,11 +46,18 @@ private:
     juce::Slider sustainSlider;
     juce::Slider panningSlider;
     juce::Slider pitchSlider;
+    juce::ComboBox playModeSelector; //forward, reverse, ping pong or granular
+    juce::ComboBox chokeGroupSelector;
     
     //pointer vectors
     std::vector<juce::Label*> labels = {&volumeLabel, &attackLabel, &decayLabel, &sustainLabel};
     std::vector<juce::Slider*> sliders = {&volumeSlider, &attackSlider, &decaySlider, &sustainSlider};
     
+    //sliders are attached to the bank's parameters in the processor's value tree
+    using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+    std::vector<std::unique_ptr<SliderAttachment>> sliderAttachments;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> playModeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> chokeGroupAttachment;
     
     Bank& bank;
     
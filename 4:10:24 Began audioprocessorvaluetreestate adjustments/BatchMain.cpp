@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+    BatchMain.cpp
+    Created: 9 Oct 2024 6:14:55pm
+    Author:  Jake
+
+    Headless chopper, built by SampleChopperBatch.jucer without any GUI modules.
+
+    SampleChopperBatch <input folder> <output folder> [--sensitivity=10] [--window=20]
+                       [--min-slice-ms=20] [--bits=24] [--threads=<cores>]
+
+    Every audio file in the input folder gets its own folder in the output, named after the file
+    and its extension (break_wav), with a WAV per slice and a JSON slice map.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "TransientDetector.h"
+#include "Slicer.h"
+
+struct BatchSettings
+{
+    juce::File outputFolder;
+    TransientDetector::Settings detectorSettings;
+    double minimumSliceMs = 20.0;
+    int bitsPerSample = 24;
+
+    //each worker only holds one chunk of audio at a time, whatever the file length
+    static constexpr int chunkSize = 65536;
+};
+
+struct BatchResults
+{
+    std::atomic<int> filesChopped {0};
+    std::atomic<int> filesFailed {0};
+    std::atomic<int> slicesWritten {0};
+
+    juce::CriticalSection outputLock;
+
+    void print(const juce::String& message)
+    {
+        const juce::ScopedLock lock(outputLock);
+        std::cout << message << std::endl;
+    }
+};
+
+//detects, slices and writes one file, run on the thread pool
+class ChopJob : public juce::ThreadPoolJob
+{
+public:
+    ChopJob(const juce::File& file, const BatchSettings& batchSettings, BatchResults& batchResults)
+        : juce::ThreadPoolJob(file.getFileName()), inputFile(file), settings(batchSettings), results(batchResults)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        if(chop())
+        {
+            results.filesChopped++;
+        }else
+        {
+            results.filesFailed++;
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    bool chop()
+    {
+        //a format manager per job, so workers share nothing but the results
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(inputFile));
+
+        if(reader == nullptr)
+        {
+            results.print("Couldn't read " + inputFile.getFullPathName());
+            return false;
+        }
+
+        const auto transients = TransientDetector::detect(*reader, settings.detectorSettings, BatchSettings::chunkSize);
+        const auto minimumSliceLength = static_cast<juce::int64>(settings.minimumSliceMs * 0.001 * reader->sampleRate);
+        const auto slices = Slicer::fromTransients(transients, reader->sampleRate, reader->lengthInSamples, minimumSliceLength);
+
+        //the extension is part of the folder's name, so break.wav and break.aiff don't write over each other
+        const auto name = inputFile.getFileNameWithoutExtension();
+        auto folder = settings.outputFolder.getChildFile(name + "_" + inputFile.getFileExtension().substring(1));
+
+        if(!folder.createDirectory())
+        {
+            results.print("Couldn't create " + folder.getFullPathName());
+            return false;
+        }
+
+        juce::AudioBuffer<float> scratch(juce::jmin(2, static_cast<int>(reader->numChannels)), BatchSettings::chunkSize);
+        juce::StringArray sliceFiles;
+
+        for(int i = 0; i < slices.size(); i++)
+        {
+            if(shouldExit())
+            {
+                return false;
+            }
+
+            const auto sliceName = name + "_" + juce::String(i).paddedLeft('0', 3) + ".wav";
+
+            if(!Slicer::writeSlice(*reader, slices[i], folder.getChildFile(sliceName), settings.bitsPerSample, scratch))
+            {
+                results.print("Couldn't write " + folder.getChildFile(sliceName).getFullPathName());
+                return false;
+            }
+
+            sliceFiles.add(sliceName);
+        }
+
+        auto sliceMap = Slicer::toJSON(slices, reader->sampleRate, sliceFiles);
+
+        if(!folder.getChildFile(name + ".json").replaceWithText(juce::JSON::toString(sliceMap)))
+        {
+            results.print("Couldn't write the slice map for " + name);
+            return false;
+        }
+
+        results.slicesWritten += static_cast<int>(slices.size());
+        results.print(inputFile.getFileName() + ": " + juce::String(static_cast<int>(slices.size())) + " slices");
+        return true;
+    }
+
+    juce::File inputFile;
+    const BatchSettings& settings;
+    BatchResults& results;
+};
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if(args.size() < 2)
+    {
+        std::cout << "Usage: SampleChopperBatch <input folder> <output folder> [--sensitivity=10] [--window=20]"
+                     " [--min-slice-ms=20] [--bits=24] [--threads=<cores>]" << std::endl;
+        return 1;
+    }
+
+    const auto inputFolder = args[0].resolveAsFile();
+
+    BatchSettings settings;
+    settings.outputFolder = args[1].resolveAsFile();
+
+    if(!inputFolder.isDirectory() || !settings.outputFolder.createDirectory())
+    {
+        std::cout << "The input folder has to exist and the output folder has to be writable" << std::endl;
+        return 1;
+    }
+
+    auto optionOr = [&args](const juce::String& option, double defaultValue)
+    {
+        return args.containsOption(option) ? args.getValueForOption(option).getDoubleValue() : defaultValue;
+    };
+
+    settings.detectorSettings.sensitivity = static_cast<float>(optionOr("--sensitivity", 10.0));
+    settings.detectorSettings.windowSizeDivisor = static_cast<int>(optionOr("--window", 20.0));
+    settings.minimumSliceMs = optionOr("--min-slice-ms", 20.0);
+    settings.bitsPerSample = static_cast<int>(optionOr("--bits", 24.0));
+    const int numberOfThreads = juce::jmax(1, static_cast<int>(optionOr("--threads", juce::SystemStats::getNumCpus())));
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    const auto files = inputFolder.findChildFiles(juce::File::findFiles, false, formatManager.getWildcardForAllFormats());
+
+    BatchResults results;
+
+    {
+        //one job per file, the pool size bounds how many files are open at once
+        juce::ThreadPool pool(numberOfThreads);
+
+        for(const auto& file : files)
+        {
+            pool.addJob(new ChopJob(file, settings, results), true);
+        }
+
+        while(pool.getNumJobs() > 0)
+        {
+            juce::Thread::sleep(50);
+        }
+    }
+
+    std::cout << results.filesChopped.load() << " files, " << results.slicesWritten.load() << " slices, "
+              << results.filesFailed.load() << " failed" << std::endl;
+
+    return results.filesFailed > 0 ? 2 : 0;
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    BeatGrid.cpp
+    Created: 15 Oct 2024 9:44:18am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "BeatGrid.h"
+
+//nearest point on a grid of spacing 'length' that passes through 'anchor', kept inside the file
+static double snapToGrid(double seconds, double anchor, double length, double fileLength)
+{
+    const double snapped = anchor + std::round((seconds - anchor) / length) * length;
+    return juce::jlimit(0.0, fileLength, snapped);
+}
+
+double BeatGrid::snapToBeat(double seconds) const
+{
+    return isValid() ? snapToGrid(seconds, firstBeat, getBeatLength(), lengthInSeconds) : seconds;
+}
+
+double BeatGrid::snapToBar(double seconds) const
+{
+    return isValid() ? snapToGrid(seconds, firstDownbeat, getBarLength(), lengthInSeconds) : seconds;
+}
+
+BeatGrid BeatGrid::fromBeats(double bpm, const float* positions, const float* strengths, int numBeats, double lengthInSeconds)
+{
+    BeatGrid grid;
+    grid.lengthInSeconds = lengthInSeconds;
+
+    if(bpm <= 0.0)
+    {
+        return grid;
+    }
+
+    grid.bpm = bpm;
+    const double beatLength = grid.getBeatLength();
+
+    //phase, each beat votes with its strength for where in the beat it landed
+    double sumX = 0.0, sumY = 0.0;
+
+    for(int i = 0; i < numBeats; i++)
+    {
+        const double angle = juce::MathConstants<double>::twoPi * positions[i] / beatLength;
+        sumX += strengths[i] * std::cos(angle);
+        sumY += strengths[i] * std::sin(angle);
+    }
+
+    double phase = 0.0;
+
+    if(sumX != 0.0 || sumY != 0.0)
+    {
+        phase = std::atan2(sumY, sumX) / juce::MathConstants<double>::twoPi * beatLength;
+
+        if(phase < 0.0)
+        {
+            phase += beatLength;
+        }
+    }
+
+    grid.firstBeat = phase;
+
+    //downbeat, the beat of the bar with the most energy on it
+    std::vector<double> barStrengths(static_cast<size_t>(grid.beatsPerBar), 0.0);
+
+    for(int i = 0; i < numBeats; i++)
+    {
+        const double beatIndex = std::round((positions[i] - phase) / beatLength);
+
+        if(std::abs(positions[i] - (phase + beatIndex * beatLength)) < beatLength * 0.25) //ignore beats off the grid
+        {
+            const int beatInBar = ((static_cast<int>(beatIndex) % grid.beatsPerBar) + grid.beatsPerBar) % grid.beatsPerBar;
+            barStrengths[static_cast<size_t>(beatInBar)] += strengths[i];
+        }
+    }
+
+    const auto strongest = std::max_element(barStrengths.begin(), barStrengths.end()) - barStrengths.begin();
+    grid.firstDownbeat = phase + static_cast<double>(strongest) * beatLength;
+
+    return grid;
+}
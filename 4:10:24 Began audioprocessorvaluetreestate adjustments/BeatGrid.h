@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    BeatGrid.h
+    Created: 15 Oct 2024 9:44:18am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//Tempo and beat positions of a sample, everything in seconds from the start of the file
+struct BeatGrid
+{
+    double bpm = 0.0; //0 when no tempo was found
+    double firstBeat = 0.0; //the first beat at or after the start of the file
+    double firstDownbeat = 0.0; //the first beat of a bar
+    int beatsPerBar = 4;
+    double lengthInSeconds = 0.0;
+
+    bool isValid() const
+    {
+        return bpm > 0.0;
+    }
+
+    double getBeatLength() const
+    {
+        return 60.0 / bpm;
+    }
+
+    double getBarLength() const
+    {
+        return getBeatLength() * beatsPerBar;
+    }
+
+    double snapToBeat(double seconds) const;
+    double snapToBar(double seconds) const;
+
+    //fits a grid to detected beat positions: the phase is the strength weighted circular mean of the
+    //positions against the beat length, and the downbeat is whichever of the bar's beats is strongest
+    static BeatGrid fromBeats(double bpm, const float* positions, const float* strengths, int numBeats, double lengthInSeconds);
+};
@@ -0,0 +1,275 @@
+/*
+  ==============================================================================
+
+    BenchmarkMain.cpp
+    Created: 10 Oct 2024 2:03:41pm
+    Author:  Jake
+
+    Processor benchmark, built by SampleChopperBenchmark.jucer.
+
+    SampleChopperBenchmark [--seconds=10] [--output=results.json] [--quick]
+
+    Runs SampleChopperAudioProcessor offline on generated drum loops across block sizes,
+    sample rates, resampling ratios and numbers of active banks, and prints JSON with
+    ns per sample, the worst block and how many allocations happened inside processBlock.
+
+    Only operator new is counted. JUCE's HeapBlock, and so AudioBuffer::setSize, allocates with
+    std::malloc, so a buffer resized on the audio thread won't show up in the count.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "PluginProcessor.h"
+
+//==============================================================================
+//allocation counting, only allocations made on a thread that has switched it on are counted. This covers every
+//operator new, including the aligned ones, but not malloc, calloc or realloc called directly, see the top of the file
+static thread_local bool countingAllocations = false;
+static std::atomic<juce::int64> allocationCount {0};
+
+void* operator new(std::size_t size)
+{
+    if(countingAllocations)
+    {
+        allocationCount++;
+    }
+
+    if(void* memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if(countingAllocations)
+    {
+        allocationCount++;
+    }
+
+    void* memory = nullptr;
+
+    if(posix_memalign(&memory, juce::jmax(sizeof(void*), static_cast<std::size_t>(alignment)), size == 0 ? 1 : size) == 0)
+    {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+//==============================================================================
+struct BenchmarkCase
+{
+    int blockSize = 512;
+    double sampleRate = 44100.0;
+    double sourceSampleRate = 44100.0; //the generated loop's rate, resampled to sampleRate
+    float pitchSemitones = 0.0f; //on top of the sample rate conversion
+    int activeBanks = 5;
+};
+
+struct BenchmarkResult
+{
+    double nanosecondsPerSample = 0.0;
+    double worstBlockMicroseconds = 0.0;
+    double worstBlockLoad = 0.0; //worst block time over the block's duration, 1.0 means it only just made it
+    juce::int64 allocations = 0;
+};
+
+//a bar of kicks, snares and hats with a sine under it, so every bank has something to play
+static SampleBuffer::Ptr createTestLoop(double sampleRate)
+{
+    const int length = static_cast<int>(sampleRate * 2.0);
+    const int hitLength = static_cast<int>(sampleRate * 0.1);
+    juce::AudioBuffer<float> loop(2, length);
+    juce::Random random(1234);
+
+    for(int i = 0; i < length; i++)
+    {
+        const int positionInHit = i % hitLength;
+        const float decay = std::exp(-8.0f * positionInHit / hitLength);
+        const float noise = random.nextFloat() * 2.0f - 1.0f;
+        const float tone = std::sin(juce::MathConstants<float>::twoPi * 55.0f * i / static_cast<float>(sampleRate));
+
+        loop.setSample(0, i, 0.5f * decay * noise + 0.3f * tone);
+        loop.setSample(1, i, 0.5f * decay * (random.nextFloat() * 2.0f - 1.0f) + 0.3f * tone);
+    }
+
+    return new SampleBuffer(loop, sampleRate);
+}
+
+static BenchmarkResult runCase(const BenchmarkCase& benchmarkCase, double seconds)
+{
+    auto processor = std::make_unique<SampleChopperAudioProcessor>();
+    auto sample = createTestLoop(benchmarkCase.sourceSampleRate);
+
+    auto& engine = processor->getSequencerEngine();
+
+    for(int i = 1; i <= 6; i++)
+    {
+        Bank* bank = processor->getBank(i);
+        bank->setSample(sample);
+        bank->setLoopRegion(0.0f, 1.0f);
+    }
+
+    for(int bank = 0; bank < SampleChopperAudioProcessor::numberOfSampleBanks; bank++)
+    {
+        auto* pitch = processor->apvts.getParameter(SampleChopperAudioProcessor::getBankParameterID(bank + 1, "Pitch"));
+        pitch->setValueNotifyingHost(pitch->convertTo0to1(benchmarkCase.pitchSemitones));
+
+        for(int step = 0; step < 16; step++) //retrigger every active bank on every 1/32
+        {
+            engine.setStep(bank, step, bank < benchmarkCase.activeBanks);
+        }
+    }
+
+    engine.setStepsPerBeat(8.0);
+    engine.setInternalBpm(174.0);
+    engine.setInternalTransportRunning(true);
+
+    processor->setRateAndBufferSizeDetails(benchmarkCase.sampleRate, benchmarkCase.blockSize);
+    processor->prepareToPlay(benchmarkCase.sampleRate, benchmarkCase.blockSize);
+
+    juce::AudioBuffer<float> buffer(2, benchmarkCase.blockSize);
+    juce::MidiBuffer midi;
+
+    const int warmUpBlocks = 16;
+    const auto numberOfBlocks = static_cast<int>(seconds * benchmarkCase.sampleRate / benchmarkCase.blockSize);
+
+    BenchmarkResult result;
+    juce::int64 totalTicks = 0;
+    juce::int64 worstTicks = 0;
+
+    for(int block = 0; block < warmUpBlocks + numberOfBlocks; block++)
+    {
+        buffer.clear();
+
+        const bool measuring = block >= warmUpBlocks;
+        const auto allocationsBefore = allocationCount.load();
+
+        countingAllocations = measuring;
+        const auto start = juce::Time::getHighResolutionTicks();
+        processor->processBlock(buffer, midi);
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+        countingAllocations = false;
+
+        if(measuring)
+        {
+            totalTicks += elapsed;
+            worstTicks = juce::jmax(worstTicks, elapsed);
+            result.allocations += allocationCount.load() - allocationsBefore;
+        }
+    }
+
+    processor->releaseResources();
+
+    const double totalSeconds = juce::Time::highResolutionTicksToSeconds(totalTicks);
+    const double worstSeconds = juce::Time::highResolutionTicksToSeconds(worstTicks);
+
+    result.nanosecondsPerSample = totalSeconds * 1.0e9 / (static_cast<double>(numberOfBlocks) * benchmarkCase.blockSize);
+    result.worstBlockMicroseconds = worstSeconds * 1.0e6;
+    result.worstBlockLoad = worstSeconds / (benchmarkCase.blockSize / benchmarkCase.sampleRate);
+    return result;
+}
+
+static std::vector<BenchmarkCase> createCases(bool quick)
+{
+    const std::vector<int> blockSizes = quick ? std::vector<int>{64, 512} : std::vector<int>{32, 64, 128, 256, 512, 1024};
+    const std::vector<double> sampleRates = quick ? std::vector<double>{48000.0} : std::vector<double>{44100.0, 48000.0, 96000.0};
+    const std::vector<float> pitches = quick ? std::vector<float>{0.0f, 7.0f} : std::vector<float>{0.0f, 7.0f, -12.0f};
+    const std::vector<int> activeBanks = quick ? std::vector<int>{5} : std::vector<int>{1, 3, 5};
+
+    std::vector<BenchmarkCase> cases;
+
+    for(auto blockSize : blockSizes)
+        for(auto sampleRate : sampleRates)
+            for(auto pitch : pitches)
+                for(auto banks : activeBanks)
+                {
+                    BenchmarkCase benchmarkCase;
+                    benchmarkCase.blockSize = blockSize;
+                    benchmarkCase.sampleRate = sampleRate;
+                    benchmarkCase.sourceSampleRate = 44100.0;
+                    benchmarkCase.pitchSemitones = pitch;
+                    benchmarkCase.activeBanks = banks;
+                    cases.push_back(benchmarkCase);
+                }
+
+    return cases;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; //the processor owns a thumbnail cache thread
+    juce::ArgumentList args(argc, argv);
+
+    const double seconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 10.0;
+    const bool quick = args.containsOption("--quick");
+
+    juce::Array<juce::var> results;
+
+    for(const auto& benchmarkCase : createCases(quick))
+    {
+        const auto result = runCase(benchmarkCase, seconds);
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("blockSize", benchmarkCase.blockSize);
+        entry->setProperty("sampleRate", benchmarkCase.sampleRate);
+        entry->setProperty("sourceSampleRate", benchmarkCase.sourceSampleRate);
+        entry->setProperty("pitchSemitones", benchmarkCase.pitchSemitones);
+        entry->setProperty("activeBanks", benchmarkCase.activeBanks);
+        entry->setProperty("nsPerSample", result.nanosecondsPerSample);
+        entry->setProperty("worstBlockUs", result.worstBlockMicroseconds);
+        entry->setProperty("worstBlockLoad", result.worstBlockLoad);
+        entry->setProperty("allocations", result.allocations);
+        results.add(juce::var(entry));
+
+        std::cerr << "block " << benchmarkCase.blockSize << " @ " << benchmarkCase.sampleRate << "Hz, pitch " << benchmarkCase.pitchSemitones
+                  << ", " << benchmarkCase.activeBanks << " banks: " << result.nanosecondsPerSample << " ns/sample, worst "
+                  << result.worstBlockMicroseconds << "us, " << result.allocations << " allocations" << std::endl;
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("juce", juce::SystemStats::getJUCEVersion());
+    root->setProperty("secondsPerCase", seconds);
+    root->setProperty("results", results);
+
+    const auto json = juce::JSON::toString(juce::var(root));
+
+    if(args.containsOption("--output"))
+    {
+        if(!args.getFileForOption("--output").replaceWithText(json))
+        {
+            std::cerr << "Couldn't write " << args.getValueForOption("--output") << std::endl;
+            return 1;
+        }
+    }else
+    {
+        std::cout << json << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    GranularEngine.cpp
+    Created: 18 Oct 2024 11:37:12am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "GranularEngine.h"
+
+const std::array<GranularEngine::WindowTable, 2>& GranularEngine::getWindowTables()
+{
+    static const auto tables = []
+    {
+        std::array<WindowTable, 2> newTables {};
+
+        for(int i = 0; i <= windowTableSize; i++)
+        {
+            const float phase = static_cast<float>(i) / windowTableSize;
+
+            newTables[static_cast<size_t>(Window::hann)][static_cast<size_t>(i)] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * phase);
+
+            //flat for the middle half with half a hann at each end, keeps more of the source at the same density
+            const float edge = juce::jmin(phase, 1.0f - phase) * 4.0f;
+            newTables[static_cast<size_t>(Window::tukey)][static_cast<size_t>(i)] = edge >= 1.0f ? 1.0f : 0.5f - 0.5f * std::cos(juce::MathConstants<float>::pi * edge);
+        }
+
+        return newTables;
+    }();
+
+    return tables;
+}
+
+void GranularEngine::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    getWindowTables(); //built here rather than by the first grain
+
+    for(auto* buffers : {&mix, &scratch})
+    {
+        for(auto& buffer : *buffers)
+        {
+            buffer.assign(static_cast<size_t>(juce::jmax(1, maximumBlockSize)), 0.0f);
+        }
+    }
+
+    numActiveGrains = 0;
+    scanning = false;
+}
+
+void GranularEngine::setParameters(const Parameters& newParameters)
+{
+    parameters = newParameters;
+}
+
+void GranularEngine::start(double position, int newRegionStart, int newRegionEnd)
+{
+    regionStart = newRegionStart;
+    regionEnd = newRegionEnd;
+    playhead = position;
+    numActiveGrains = 0;
+    scanning = playhead < regionEnd;
+    samplesUntilGrain = 0.0; //the first grain starts with the note
+}
+
+void GranularEngine::process(const SampleBuffer& sample, int numSamples, double scanIncrement, const float* pitchRatios)
+{
+    numSamples = juce::jmin(numSamples, static_cast<int>(mix[0].size()));
+
+    juce::FloatVectorOperations::clear(mix[0].data(), numSamples);
+    juce::FloatVectorOperations::clear(mix[1].data(), numSamples);
+
+    //new grains at their exact sample in the block, taken from where the playhead will be by then
+    const double grainInterval = sampleRate / juce::jmax(0.1f, parameters.density);
+
+    while(scanning && samplesUntilGrain < numSamples)
+    {
+        const int delay = juce::jmax(0, static_cast<int>(samplesUntilGrain));
+        startGrain(sample, delay, scanIncrement, pitchRatios[delay]);
+        samplesUntilGrain += grainInterval;
+    }
+
+    if(scanning)
+    {
+        samplesUntilGrain -= numSamples;
+    }
+
+    playhead += scanIncrement * numSamples;
+
+    if(playhead >= regionEnd)
+    {
+        scanning = false; //the grains already started play out
+    }
+
+    for(int i = 0; i < numActiveGrains;)
+    {
+        renderGrain(grains[static_cast<size_t>(i)], sample, numSamples);
+
+        if(grains[static_cast<size_t>(i)].remaining <= 0)
+        {
+            std::swap(grains[static_cast<size_t>(i)], grains[static_cast<size_t>(--numActiveGrains)]);
+        }else
+        {
+            i++;
+        }
+    }
+}
+
+void GranularEngine::startGrain(const SampleBuffer& sample, int delay, double scanIncrement, float pitchRatio)
+{
+    if(numActiveGrains >= maxGrains)
+    {
+        return;
+    }
+
+    const double increment = scanIncrement * std::exp2(parameters.pitch / 12.0) * pitchRatio;
+    int length = juce::jmax(1, juce::roundToInt(parameters.size * sampleRate));
+
+    //spray scatters the start either side of the playhead, kept inside the region where it fits
+    const double spray = parameters.spray * (regionEnd - regionStart) * (random.nextDouble() * 2.0 - 1.0);
+    const double span = length * increment;
+    const double latestStart = juce::jmax(static_cast<double>(regionStart), regionEnd - span);
+    double position = juce::jlimit(static_cast<double>(regionStart), latestStart, playhead + delay * scanIncrement + spray);
+
+    //a grain longer than what's left of the file is shortened rather than read past the padding
+    length = juce::jmin(length, static_cast<int>((sample.getNumSamples() - 1 - position) / increment));
+
+    if(length <= 1)
+    {
+        return;
+    }
+
+    //overlapping grains add up, scaled by the square root of the overlap as a middle ground between
+    //grains that line up and ones that don't
+    const float overlap = parameters.density * parameters.size;
+
+    auto& grain = grains[static_cast<size_t>(numActiveGrains++)];
+    grain.position = position;
+    grain.increment = increment;
+    grain.windowPhase = 0.0f;
+    grain.windowIncrement = static_cast<float>(windowTableSize) / length;
+    grain.remaining = length;
+    grain.delay = delay;
+    grain.gain = 1.0f / std::sqrt(juce::jmax(1.0f, overlap));
+    grain.window = parameters.window;
+}
+
+void GranularEngine::renderGrain(Grain& grain, const SampleBuffer& sample, int numSamples)
+{
+    const int begin = grain.delay;
+    const int length = juce::jmin(numSamples - begin, grain.remaining);
+    grain.delay = juce::jmax(0, grain.delay - numSamples);
+
+    if(length <= 0)
+    {
+        return;
+    }
+
+    const float* sourceLeft = sample.getReadPointer(0);
+    const float* sourceRight = sample.getReadPointer(juce::jmin(1, sample.getNumChannels() - 1));
+    const float* window = getWindowTables()[static_cast<size_t>(grain.window)].data();
+
+    //positions are relative to a whole sample so the loop works in floats, which is accurate enough over one block
+    const int base = static_cast<int>(grain.position);
+    const float offset = static_cast<float>(grain.position - base);
+    const float increment = static_cast<float>(grain.increment);
+    const float windowPhase = grain.windowPhase;
+    const float windowIncrement = grain.windowIncrement;
+
+    const float* left = sourceLeft + base;
+    const float* right = sourceRight + base;
+    float* scratchLeft = scratch[0].data();
+    float* scratchRight = scratch[1].data();
+
+    //every sample is worked out from i alone, nothing is carried from one to the next, so it vectorises
+    for(int i = 0; i < length; i++)
+    {
+        const float position = offset + i * increment;
+        const int index = static_cast<int>(position);
+        const float fraction = position - index;
+
+        const float phase = windowPhase + i * windowIncrement;
+        const int windowIndex = juce::jmin(static_cast<int>(phase), windowTableSize - 1);
+        const float windowFraction = phase - windowIndex;
+        const float gain = window[windowIndex] + windowFraction * (window[windowIndex + 1] - window[windowIndex]);
+
+        scratchLeft[i] = (left[index] + fraction * (left[index + 1] - left[index])) * gain;
+        scratchRight[i] = (right[index] + fraction * (right[index + 1] - right[index])) * gain;
+    }
+
+    juce::FloatVectorOperations::addWithMultiply(mix[0].data() + begin, scratchLeft, grain.gain, length);
+    juce::FloatVectorOperations::addWithMultiply(mix[1].data() + begin, scratchRight, grain.gain, length);
+
+    grain.position += grain.increment * length;
+    grain.windowPhase += windowIncrement * length;
+    grain.remaining -= length;
+}
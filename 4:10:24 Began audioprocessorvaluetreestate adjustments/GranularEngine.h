@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    GranularEngine.h
+    Created: 18 Oct 2024 11:37:12am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleBuffer.h"
+
+//Plays a bank's region as overlapping windowed grains. A playhead scans through the region at the bank's speed
+//and grains are started from around it at a steady rate, so the grain pitch transposes without changing how long
+//the region takes to play through.
+//
+//Grains come from a fixed pool and their windows are read from tables built once, so nothing is allocated or
+//evaluated per grain on the audio thread. Each grain is rendered a span at a time into scratch buffers by a loop
+//with no dependency between samples, then mixed in with FloatVectorOperations.
+class GranularEngine
+{
+public:
+    static constexpr int maxGrains = 128; //a grain that would go over this is skipped
+    static constexpr int windowTableSize = 1024;
+
+    enum class Window { hann, tukey };
+
+    struct Parameters
+    {
+        float density = 40.0f; //grains per second
+        float size = 0.08f; //seconds
+        float spray = 0.1f; //0 - 1, how far through the region a grain can start from the playhead
+        float pitch = 0.0f; //semitones
+        Window window = Window::hann;
+    };
+
+    //not the audio thread, sizes the mix buffers and builds the window tables on first use
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    //audio thread, once per block, picked up by the next grain
+    void setParameters(const Parameters& newParameters);
+
+    //audio thread, drops any grains still playing and starts scanning from position, in samples of the file
+    void start(double position, int regionStart, int regionEnd);
+
+    //true while the playhead is inside the region or any grain is still sounding
+    bool isPlaying() const
+    {
+        return scanning || numActiveGrains > 0;
+    }
+
+    double getPlayhead() const
+    {
+        return playhead;
+    }
+
+    //renders numSamples, up to the prepared block size, into the mix buffers.
+    //scanIncrement is file samples per output sample, pitchRatios are per sample and transpose new grains
+    void process(const SampleBuffer& sample, int numSamples, double scanIncrement, const float* pitchRatios);
+
+    const float* getOutput(int channel) const
+    {
+        return mix[static_cast<size_t>(juce::jlimit(0, 1, channel))].data();
+    }
+
+private:
+    struct Grain
+    {
+        double position = 0.0; //in samples of the file
+        double increment = 1.0;
+        float windowPhase = 0.0f; //in table entries
+        float windowIncrement = 0.0f;
+        int remaining = 0; //output samples left
+        int delay = 0; //samples into the current block before it starts
+        float gain = 1.0f;
+        Window window = Window::hann;
+    };
+
+    void startGrain(const SampleBuffer& sample, int delay, double scanIncrement, float pitchRatio);
+    void renderGrain(Grain& grain, const SampleBuffer& sample, int numSamples);
+
+    //one guard entry at the end for the interpolation
+    using WindowTable = std::array<float, windowTableSize + 1>;
+    static const std::array<WindowTable, 2>& getWindowTables();
+
+    Parameters parameters;
+    double sampleRate = 44100.0;
+
+    std::array<Grain, maxGrains> grains;
+    int numActiveGrains = 0; //the first numActiveGrains of the pool, finished grains are swapped to the end
+
+    double playhead = 0.0;
+    int regionStart = 0, regionEnd = 0;
+    bool scanning = false;
+    double samplesUntilGrain = 0.0;
+    juce::Random random;
+
+    std::array<std::vector<float>, 2> mix;
+    std::array<std::vector<float>, 2> scratch;
+};
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    InputRecorder.cpp
+    Created: 18 Oct 2024 4:52:30pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "InputRecorder.h"
+
+InputRecorder::~InputRecorder()
+{
+    cancelPendingUpdate();
+}
+
+void InputRecorder::prepare(double newSampleRate)
+{
+    //a take can't change sample rate half way through, the host doesn't call processBlock while this runs
+    if(newSampleRate != sampleRate.load() && state.load() == State::recording)
+    {
+        state = State::armed;
+    }
+
+    sampleRate = newSampleRate;
+}
+
+void InputRecorder::arm()
+{
+    if(state.load() != State::idle)
+    {
+        return;
+    }
+
+    const int ringSize = static_cast<int>(maxSeconds * sampleRate.load());
+
+    if(ring.getNumSamples() != ringSize)
+    {
+        ring.setSize(2, ringSize);
+    }
+
+    stopRequested = false;
+    state = State::armed;
+}
+
+void InputRecorder::stop()
+{
+    auto expected = State::armed;
+
+    if(state.compare_exchange_strong(expected, State::idle)) //nothing was recorded
+    {
+        return;
+    }
+
+    if(expected == State::recording)
+    {
+        stopRequested = true;
+    }
+}
+
+void InputRecorder::process(const juce::AudioBuffer<float>& input, int numSamples)
+{
+    auto current = state.load();
+
+    if(current == State::idle || current == State::finished)
+    {
+        return;
+    }
+
+    const int numChannels = juce::jmin(input.getNumChannels(), 2);
+
+    if(numChannels == 0)
+    {
+        return;
+    }
+
+    int start = 0;
+
+    if(current == State::armed)
+    {
+        //the take starts on the first sample loud enough on either channel
+        for(start = 0; start < numSamples; start++)
+        {
+            bool triggered = false;
+
+            for(int channel = 0; channel < numChannels; channel++)
+            {
+                triggered |= std::abs(input.getSample(channel, start)) > triggerLevel;
+            }
+
+            if(triggered)
+            {
+                break;
+            }
+        }
+
+        //stop() may have disarmed since the state was read
+        if(start == numSamples || !state.compare_exchange_strong(current, State::recording))
+        {
+            return;
+        }
+
+        writePosition = 0;
+        samplesWritten = 0;
+    }
+
+    if(stopRequested.exchange(false))
+    {
+        state = State::finished; //hands the ring to the message thread
+        triggerAsyncUpdate();
+        return;
+    }
+
+    //into the ring in at most two pieces, wrapping over the oldest audio
+    const int ringSize = ring.getNumSamples();
+
+    for(int position = start; position < numSamples;)
+    {
+        const int length = juce::jmin(numSamples - position, ringSize - writePosition);
+
+        for(int channel = 0; channel < 2; channel++)
+        {
+            ring.copyFrom(channel, writePosition, input, juce::jmin(channel, numChannels - 1), position, length);
+        }
+
+        position += length;
+        writePosition = (writePosition + length) % ringSize;
+        samplesWritten += length;
+    }
+}
+
+void InputRecorder::handleAsyncUpdate()
+{
+    if(state.load() != State::finished)
+    {
+        return;
+    }
+
+    const int ringSize = ring.getNumSamples();
+    const int length = static_cast<int>(juce::jmin(samplesWritten, static_cast<juce::int64>(ringSize)));
+    SampleBuffer::Ptr take;
+
+    if(length > 0)
+    {
+        //oldest first, once the ring has wrapped that's wherever the next write would have gone
+        const int oldest = samplesWritten > ringSize ? writePosition : 0;
+        const int firstPart = juce::jmin(length, ringSize - oldest);
+
+        juce::AudioBuffer<float> audio(2, length);
+
+        for(int channel = 0; channel < 2; channel++)
+        {
+            audio.copyFrom(channel, 0, ring, channel, oldest, firstPart);
+
+            if(length > firstPart)
+            {
+                audio.copyFrom(channel, firstPart, ring, channel, 0, length - firstPart);
+            }
+        }
+
+        take = new SampleBuffer(audio, sampleRate.load());
+    }
+
+    state = State::idle;
+
+    if(take != nullptr && onRecordingFinished != nullptr)
+    {
+        onRecordingFinished(take);
+    }
+}
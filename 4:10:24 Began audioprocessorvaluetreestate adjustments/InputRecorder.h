@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    InputRecorder.h
+    Created: 18 Oct 2024 4:52:30pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleBuffer.h"
+
+//Records the host's input into a ring buffer that's allocated when recording is armed, so the audio thread only
+//ever copies into memory that's already there. Once armed, the take starts on the first sample over triggerLevel.
+//When it's stopped the ring is unwrapped into a new SampleBuffer on the message thread and handed to
+//onRecordingFinished. A take longer than the ring keeps its last maxSeconds.
+//
+//The state is the only thing the two threads share: the audio thread owns the ring until it sets finished,
+//and the message thread owns it from then until it goes back to idle.
+class InputRecorder : private juce::AsyncUpdater
+{
+public:
+    enum class State { idle, armed, recording, finished };
+
+    static constexpr double maxSeconds = 60.0;
+    static constexpr float triggerLevel = 0.01f; //-40dB
+
+    ~InputRecorder() override;
+
+    //not the audio thread
+    void prepare(double sampleRate);
+
+    //message thread, arm allocates the ring the first time and does nothing unless idle
+    void arm();
+    void stop(); //cancels an armed recording that hasn't started, or finishes the take at the next block
+
+    State getState() const
+    {
+        return state.load();
+    }
+
+    //audio thread, up to two channels, a mono input is recorded on both
+    void process(const juce::AudioBuffer<float>& input, int numSamples);
+
+    //message thread, with the finished take
+    std::function<void(SampleBuffer::Ptr)> onRecordingFinished;
+
+private:
+    void handleAsyncUpdate() override; //builds the take once the audio thread has finished with the ring
+
+    juce::AudioBuffer<float> ring;
+    std::atomic<State> state {State::idle};
+    std::atomic<bool> stopRequested {false};
+    std::atomic<double> sampleRate {44100.0};
+
+    //audio thread while recording, message thread once finished
+    int writePosition = 0;
+    juce::int64 samplesWritten = 0;
+};
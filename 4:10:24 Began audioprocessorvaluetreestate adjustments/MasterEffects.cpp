@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    MasterEffects.cpp
+    Created: 13 Oct 2024 5:02:31pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "MasterEffects.h"
+
+void MasterEffects::prepare(double sampleRate, int maximumBlockSize, int numChannels)
+{
+    const juce::dsp::ProcessSpec spec {sampleRate, static_cast<juce::uint32>(maximumBlockSize), static_cast<juce::uint32>(numChannels)};
+
+    filter.prepare(spec);
+    compressor.prepare(spec);
+    limiter.prepare(spec);
+
+    for(int stages = 1; stages <= maxOversamplingStages; stages++)
+    {
+        for(auto filterType : {OversamplingFilter::polyphaseIIR, OversamplingFilter::equirippleFIR})
+        {
+            const auto type = filterType == OversamplingFilter::polyphaseIIR ? juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR
+                                                                             : juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple;
+
+            //integer latency so the host can compensate for it exactly
+            auto& oversampler = oversamplers[(stages - 1) * 2 + static_cast<int>(filterType)];
+            oversampler = std::make_unique<juce::dsp::Oversampling<float>>(static_cast<size_t>(numChannels), static_cast<size_t>(stages), type, true, true);
+            oversampler->initProcessing(static_cast<size_t>(maximumBlockSize));
+        }
+    }
+
+    maximumCutoff = static_cast<float>(sampleRate * 0.45);
+    maximumBlock = maximumBlockSize;
+    activeOversampler = getOversampler(parameters.oversamplingStages, parameters.oversamplingFilter);
+}
+
+void MasterEffects::reset()
+{
+    filter.reset();
+    compressor.reset();
+    limiter.reset();
+
+    for(auto& oversampler : oversamplers)
+    {
+        if(oversampler != nullptr)
+        {
+            oversampler->reset();
+        }
+    }
+}
+
+void MasterEffects::setParameters(const Parameters& newParameters)
+{
+    auto* oversampler = getOversampler(newParameters.oversamplingStages, newParameters.oversamplingFilter);
+
+    if(oversampler != activeOversampler && oversampler != nullptr)
+    {
+        oversampler->reset(); //it's been idle, so its filters hold old audio
+    }
+
+    activeOversampler = oversampler;
+    parameters = newParameters;
+
+    enabled = parameters.filterEnabled || parameters.compressorEnabled || parameters.saturatorEnabled || parameters.limiterEnabled;
+
+    if(parameters.filterEnabled)
+    {
+        switch(parameters.filterMode)
+        {
+            case FilterMode::lowpass12: filter.setMode(juce::dsp::LadderFilterMode::LPF12); break;
+            case FilterMode::lowpass24: filter.setMode(juce::dsp::LadderFilterMode::LPF24); break;
+            case FilterMode::highpass12: filter.setMode(juce::dsp::LadderFilterMode::HPF12); break;
+            case FilterMode::highpass24: filter.setMode(juce::dsp::LadderFilterMode::HPF24); break;
+            case FilterMode::bandpass12: filter.setMode(juce::dsp::LadderFilterMode::BPF12); break;
+            case FilterMode::bandpass24: filter.setMode(juce::dsp::LadderFilterMode::BPF24); break;
+        }
+
+        filter.setCutoffFrequencyHz(juce::jmin(parameters.cutoff, maximumCutoff));
+        filter.setResonance(parameters.resonance);
+    }
+
+    if(parameters.compressorEnabled)
+    {
+        compressor.setThreshold(parameters.threshold);
+        compressor.setRatio(parameters.ratio);
+        compressor.setAttack(parameters.attack);
+        compressor.setRelease(parameters.release);
+    }
+
+    if(parameters.saturatorEnabled)
+    {
+        saturationGain = juce::Decibels::decibelsToGain(parameters.saturation);
+        saturationMakeup = 1.0f / std::tanh(saturationGain);
+    }
+
+    if(parameters.limiterEnabled)
+    {
+        limiter.setThreshold(parameters.ceiling);
+        limiter.setRelease(100.0f);
+    }
+}
+
+bool MasterEffects::isEnabled() const
+{
+    return enabled;
+}
+
+int MasterEffects::getLatencySamples() const
+{
+    if(!parameters.saturatorEnabled || activeOversampler == nullptr)
+    {
+        return 0;
+    }
+
+    return juce::roundToInt(activeOversampler->getLatencyInSamples());
+}
+
+void MasterEffects::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    auto block = juce::dsp::AudioBlock<float>(buffer).getSubBlock(0, static_cast<size_t>(numSamples));
+    const juce::dsp::ProcessContextReplacing<float> context(block);
+
+    if(parameters.filterEnabled)
+    {
+        filter.process(context);
+    }
+
+    if(parameters.compressorEnabled)
+    {
+        compressor.process(context);
+    }
+
+    if(parameters.saturatorEnabled)
+    {
+        if(activeOversampler == nullptr)
+        {
+            saturate(block);
+        }else
+        {
+            //the oversampler was set up for the prepared block size, bigger blocks go through in pieces
+            for(int position = 0; position < numSamples; position += maximumBlock)
+            {
+                auto subBlock = block.getSubBlock(static_cast<size_t>(position), static_cast<size_t>(juce::jmin(maximumBlock, numSamples - position)));
+                auto oversampledBlock = activeOversampler->processSamplesUp(subBlock);
+                saturate(oversampledBlock);
+                activeOversampler->processSamplesDown(subBlock);
+            }
+        }
+    }
+
+    if(parameters.limiterEnabled)
+    {
+        limiter.process(context);
+    }
+}
+
+juce::dsp::Oversampling<float>* MasterEffects::getOversampler(int stages, OversamplingFilter filterType) const
+{
+    if(stages < 1 || stages > maxOversamplingStages)
+    {
+        return nullptr;
+    }
+
+    return oversamplers[(stages - 1) * 2 + static_cast<int>(filterType)].get();
+}
+
+void MasterEffects::saturate(juce::dsp::AudioBlock<float>& block) const
+{
+    for(size_t channel = 0; channel < block.getNumChannels(); channel++)
+    {
+        float* data = block.getChannelPointer(channel);
+
+        for(size_t i = 0; i < block.getNumSamples(); i++)
+        {
+            const float x = juce::jlimit(-5.0f, 5.0f, data[i] * saturationGain);
+            data[i] = juce::dsp::FastMathApproximations<float>::tanh(x) * saturationMakeup;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    MasterEffects.h
+    Created: 13 Oct 2024 5:02:31pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//The master bus after the banks are summed: ladder filter, compressor, saturator and limiter.
+//Only the saturator makes new harmonics, so it's the only stage that gets oversampled.
+//Every factor and filter type is set up in prepare so switching them never allocates on the audio thread,
+//the processor reports the new latency to the host when it changes.
+class MasterEffects
+{
+public:
+    enum class FilterMode { lowpass12, lowpass24, highpass12, highpass24, bandpass12, bandpass24 };
+    enum class OversamplingFilter { polyphaseIIR, equirippleFIR };
+
+    static constexpr int maxOversamplingStages = 3; //8x
+
+    struct Parameters
+    {
+        bool filterEnabled = false;
+        FilterMode filterMode = FilterMode::lowpass24;
+        float cutoff = 20000.0f; //Hz
+        float resonance = 0.0f; //0 - 1
+
+        bool compressorEnabled = false;
+        float threshold = -12.0f; //dB
+        float ratio = 4.0f;
+        float attack = 10.0f; //ms
+        float release = 100.0f; //ms
+
+        bool saturatorEnabled = false;
+        float saturation = 6.0f; //dB into the saturator
+        int oversamplingStages = 1; //0 is off, each stage doubles the rate
+        OversamplingFilter oversamplingFilter = OversamplingFilter::polyphaseIIR;
+
+        bool limiterEnabled = false;
+        float ceiling = -0.3f; //dB
+    };
+
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+    void reset();
+
+    //audio thread, once per block
+    void setParameters(const Parameters& newParameters);
+    bool isEnabled() const;
+    int getLatencySamples() const; //only the oversampled saturator adds latency
+
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+
+private:
+    juce::dsp::Oversampling<float>* getOversampler(int stages, OversamplingFilter filter) const;
+    void saturate(juce::dsp::AudioBlock<float>& block) const;
+
+    Parameters parameters;
+    bool enabled = false;
+
+    juce::dsp::LadderFilter<float> filter;
+    juce::dsp::Compressor<float> compressor;
+    juce::dsp::Limiter<float> limiter;
+
+    //one per factor and filter type, index (stages - 1) * 2 + filter
+    std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, maxOversamplingStages * 2> oversamplers;
+    juce::dsp::Oversampling<float>* activeOversampler = nullptr;
+
+    float saturationGain = 1.0f, saturationMakeup = 1.0f;
+    float maximumCutoff = 20000.0f;
+    int maximumBlock = 512;
+};
@@ -0,0 +1,209 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.cpp
+    Created: 17 Oct 2024 2:05:51pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "ModulationMatrix.h"
+
+void ModulationMatrix::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    for(int i = 0; i < numberOfBuffers; i++)
+    {
+        buffers[static_cast<size_t>(i)].resize(static_cast<size_t>(juce::jmax(1, maximumBlockSize)));
+        resetBuffer(i);
+    }
+
+    for(int i = 0; i < maxControlInterval; i++)
+    {
+        rampTable[static_cast<size_t>(i)] = static_cast<float>(i + 1);
+    }
+
+    samplesUntilTick = 0;
+}
+
+void ModulationMatrix::setParameters(const Parameters& newParameters)
+{
+    parameters = newParameters;
+    parameters.controlInterval = juce::jlimit(1, maxControlInterval, parameters.controlInterval);
+
+    juce::uint32 routed = 0;
+
+    for(const auto& slot : parameters.slots)
+    {
+        if(slot.source != Source::none && slot.amount != 0.0f)
+        {
+            routed |= 1u << static_cast<int>(slot.destination);
+        }
+    }
+
+    //a destination that's just been unrouted goes back to neutral once, rather than being filled every block
+    const juce::uint32 unrouted = routedDestinations & ~routed;
+    routedDestinations = routed;
+
+    for(int i = 0; i < numberOfBuffers; i++)
+    {
+        if((unrouted & (1u << i)) != 0)
+        {
+            resetBuffer(i);
+        }
+    }
+}
+
+void ModulationMatrix::resetBuffer(int index)
+{
+    auto& buffer = buffers[static_cast<size_t>(index)];
+    juce::FloatVectorOperations::fill(buffer.data(), neutralValues[index], static_cast<int>(buffer.size()));
+    rampValues[static_cast<size_t>(index)] = neutralValues[index];
+    rampTargets[static_cast<size_t>(index)] = neutralValues[index];
+    rampSteps[static_cast<size_t>(index)] = 0.0f;
+}
+
+void ModulationMatrix::noteOn(float velocity)
+{
+    lfoPhase = 0.0;
+    lfoHeld = random.nextFloat() * 2.0f - 1.0f;
+    envelopeSamples = 0;
+    noteVelocity = velocity;
+    noteRandom = random.nextFloat() * 2.0f - 1.0f;
+
+    //the note starts exactly on its modulation rather than ramping from wherever the last note left it
+    std::array<float, numberOfBuffers> targets;
+    computeTargets(targets, noteStartOffset);
+
+    for(int i = 0; i < numberOfBuffers; i++)
+    {
+        if(isRouted(static_cast<Destination>(i)))
+        {
+            rampValues[static_cast<size_t>(i)] = targets[static_cast<size_t>(i)];
+            rampTargets[static_cast<size_t>(i)] = targets[static_cast<size_t>(i)];
+            rampSteps[static_cast<size_t>(i)] = 0.0f;
+        }
+    }
+
+    samplesUntilTick = 0;
+}
+
+void ModulationMatrix::process(int numSamples)
+{
+    const juce::uint32 routed = routedDestinations & ((1u << numberOfBuffers) - 1);
+
+    if(routed == 0)
+    {
+        return; //the buffers already hold their neutral values
+    }
+
+    numSamples = juce::jmin(numSamples, static_cast<int>(buffers[0].size()));
+
+    for(int position = 0; position < numSamples;)
+    {
+        if(samplesUntilTick <= 0)
+        {
+            tick();
+        }
+
+        //a span never crosses a control point, so it's one straight line per destination
+        const int length = juce::jmin(samplesUntilTick, numSamples - position);
+        const int rampPosition = interval - samplesUntilTick;
+
+        for(int i = 0; i < numberOfBuffers; i++)
+        {
+            if((routed & (1u << i)) != 0)
+            {
+                float* destination = buffers[static_cast<size_t>(i)].data() + position;
+                juce::FloatVectorOperations::copyWithMultiply(destination, rampTable.data() + rampPosition, rampSteps[static_cast<size_t>(i)], length);
+                juce::FloatVectorOperations::add(destination, rampValues[static_cast<size_t>(i)], length);
+            }
+        }
+
+        samplesUntilTick -= length;
+        position += length;
+    }
+}
+
+void ModulationMatrix::tick()
+{
+    interval = parameters.controlInterval;
+    samplesUntilTick = interval;
+
+    //values at the end of the interval, the ramps get there on its last sample
+    const double lfoIncrement = parameters.bpm / (60.0 * sampleRate * juce::jmax(1.0 / 64.0, parameters.lfoBeats));
+    lfoPhase += lfoIncrement * interval;
+
+    if(lfoPhase >= 1.0)
+    {
+        lfoPhase -= std::floor(lfoPhase);
+        lfoHeld = random.nextFloat() * 2.0f - 1.0f;
+    }
+
+    envelopeSamples += interval;
+
+    //each ramp starts from exactly where the last one was aiming, so rounding doesn't build up between intervals
+    rampValues = rampTargets;
+    float startOffset = 0.0f;
+    computeTargets(rampTargets, startOffset);
+
+    for(int i = 0; i < numberOfBuffers; i++)
+    {
+        rampSteps[static_cast<size_t>(i)] = (rampTargets[static_cast<size_t>(i)] - rampValues[static_cast<size_t>(i)]) / static_cast<float>(interval);
+    }
+}
+
+void ModulationMatrix::computeTargets(std::array<float, numberOfBuffers>& targets, float& startOffset)
+{
+    float sums[4] {}; //one per Destination
+
+    if(routedDestinations != 0)
+    {
+        const float sources[] {0.0f, getLfoValue(), getEnvelopeValue(), noteVelocity, noteRandom};
+
+        for(const auto& slot : parameters.slots)
+        {
+            sums[static_cast<int>(slot.destination)] += sources[static_cast<int>(slot.source)] * slot.amount;
+        }
+    }
+
+    targets[pitchBuffer] = std::exp2(sums[static_cast<int>(Destination::pitch)] * pitchRangeSemitones / 12.0f);
+    targets[cutoffBuffer] = sums[static_cast<int>(Destination::cutoff)] * cutoffRangeOctaves;
+    targets[panBuffer] = sums[static_cast<int>(Destination::pan)];
+    startOffset = sums[static_cast<int>(Destination::startOffset)];
+}
+
+float ModulationMatrix::getLfoValue() const
+{
+    const float phase = static_cast<float>(lfoPhase);
+
+    switch(parameters.lfoShape)
+    {
+        case LfoShape::sine: return std::sin(juce::MathConstants<float>::twoPi * phase);
+        case LfoShape::triangle: return phase < 0.25f ? 4.0f * phase : (phase < 0.75f ? 2.0f - 4.0f * phase : 4.0f * phase - 4.0f);
+        case LfoShape::saw: return 2.0f * phase - 1.0f;
+        case LfoShape::square: return phase < 0.5f ? 1.0f : -1.0f;
+        case LfoShape::sampleAndHold: return lfoHeld;
+    }
+
+    return 0.0f;
+}
+
+float ModulationMatrix::getEnvelopeValue() const
+{
+    const float seconds = static_cast<float>(envelopeSamples / sampleRate);
+
+    if(seconds < parameters.envelopeAttack)
+    {
+        return seconds / parameters.envelopeAttack;
+    }
+
+    if(parameters.envelopeDecay <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    return juce::jmax(0.0f, 1.0f - (seconds - parameters.envelopeAttack) / parameters.envelopeDecay);
+}
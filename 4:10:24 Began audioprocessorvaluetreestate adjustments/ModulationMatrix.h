@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.h
+    Created: 17 Oct 2024 2:05:51pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//Per bank modulation: an LFO synced to the tempo, an attack/decay envelope, the note's velocity and a random
+//value picked per note, routed through a few slots to pitch, filter cutoff, pan and start offset.
+//
+//The modulators are only worked out every controlInterval samples. Between those points each destination is
+//a straight line, written a span at a time with FloatVectorOperations, so the voice reads one value per sample
+//and heavy modulation costs about the same as none.
+class ModulationMatrix
+{
+public:
+    enum class Source { none, lfo, envelope, velocity, random };
+    enum class Destination { pitch, cutoff, pan, startOffset };
+    enum class LfoShape { sine, triangle, saw, square, sampleAndHold };
+
+    static constexpr int numberOfSlots = 4;
+    static constexpr int maxControlInterval = 128;
+
+    //what an amount of 1 does at each destination, start offset is 0 - 1 through the region like the bank's own
+    static constexpr float pitchRangeSemitones = 24.0f;
+    static constexpr float cutoffRangeOctaves = 4.0f;
+
+    struct Slot
+    {
+        Source source = Source::none;
+        Destination destination = Destination::pitch;
+        float amount = 0.0f; //-1 - 1
+    };
+
+    struct Parameters
+    {
+        std::array<Slot, numberOfSlots> slots;
+        double lfoBeats = 1.0; //length of one LFO cycle
+        LfoShape lfoShape = LfoShape::sine;
+        float envelopeAttack = 0.01f; //seconds
+        float envelopeDecay = 0.5f;
+        int controlInterval = 32; //samples between control points
+        double bpm = 120.0;
+    };
+
+    //not the audio thread, the buffers are sized here
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    //audio thread, once per block
+    void setParameters(const Parameters& newParameters);
+
+    //audio thread, restarts the LFO and envelope and picks the note's random value
+    void noteOn(float velocity);
+
+    //the start offset modulation for the note that was just started, added to the bank's offset
+    float getNoteStartOffset() const
+    {
+        return noteStartOffset;
+    }
+
+    //fills numSamples, up to the prepared block size, of each routed destination
+    void process(int numSamples);
+
+    bool isRouted(Destination destination) const
+    {
+        return (routedDestinations & (1u << static_cast<int>(destination))) != 0;
+    }
+
+    //per sample values from the last process call, neutral for anything that isn't routed
+    const float* getPitchRatios() const { return buffers[pitchBuffer].data(); } //multiplies the speed
+    const float* getCutoffOctaves() const { return buffers[cutoffBuffer].data(); } //added to the filter's cutoff
+    const float* getPanOffsets() const { return buffers[panBuffer].data(); } //added to the bank's pan
+
+    int getControlInterval() const
+    {
+        return interval;
+    }
+
+private:
+    //the destinations that change while the note plays, start offset is only read at note on
+    enum { pitchBuffer, cutoffBuffer, panBuffer, numberOfBuffers };
+
+    void tick(); //moves the modulators on one control interval and starts the ramps towards their new values
+    void computeTargets(std::array<float, numberOfBuffers>& targets, float& startOffset);
+    float getLfoValue() const;
+    float getEnvelopeValue() const;
+    void resetBuffer(int index);
+
+    static constexpr float neutralValues[numberOfBuffers] {1.0f, 0.0f, 0.0f};
+
+    Parameters parameters;
+    juce::uint32 routedDestinations = 0;
+
+    double sampleRate = 44100.0;
+    int interval = 32; //the interval the current ramps were started with, a new setting waits for the next tick
+    int samplesUntilTick = 0;
+
+    //modulator state
+    double lfoPhase = 0.0; //0 - 1
+    float lfoHeld = 0.0f; //sample and hold's current value
+    juce::int64 envelopeSamples = 0; //since note on
+    float noteVelocity = 0.0f;
+    float noteRandom = 0.0f;
+    float noteStartOffset = 0.0f;
+    juce::Random random;
+
+    //each destination's value at the last control point, where it's heading and how far it moves per sample
+    std::array<float, numberOfBuffers> rampValues {1.0f, 0.0f, 0.0f};
+    std::array<float, numberOfBuffers> rampTargets {1.0f, 0.0f, 0.0f};
+    std::array<float, numberOfBuffers> rampSteps {};
+
+    std::array<std::vector<float>, numberOfBuffers> buffers;
+    std::array<float, maxControlInterval> rampTable {}; //1, 2, 3 ... so a ramp is one multiply and one add
+};
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    ModulationMatrixTests.cpp
+    Created: 18 Oct 2024 3:04:52pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ModulationMatrix.h"
+
+class ModulationMatrixTests : public juce::UnitTest
+{
+public:
+    ModulationMatrixTests() : juce::UnitTest("Modulation matrix", "Bank") {}
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 1000.0; //a sample a millisecond keeps the envelope's numbers easy
+        constexpr int blockSize = 64;
+
+        auto route = [](ModulationMatrix::Parameters& parameters, int slot, ModulationMatrix::Source source, ModulationMatrix::Destination destination, float amount)
+        {
+            parameters.slots[static_cast<size_t>(slot)] = {source, destination, amount};
+        };
+
+        beginTest("Unrouted destinations stay neutral");
+        {
+            ModulationMatrix matrix;
+            matrix.prepare(sampleRate, blockSize);
+            matrix.setParameters({});
+            matrix.noteOn(1.0f);
+            matrix.process(blockSize);
+
+            for(int i = 0; i < blockSize; i++)
+            {
+                expectEquals(matrix.getPitchRatios()[i], 1.0f);
+                expectEquals(matrix.getCutoffOctaves()[i], 0.0f);
+                expectEquals(matrix.getPanOffsets()[i], 0.0f);
+            }
+
+            expectEquals(matrix.getNoteStartOffset(), 0.0f);
+
+            //routed then taken off again, the destination goes straight back
+            ModulationMatrix::Parameters parameters;
+            route(parameters, 0, ModulationMatrix::Source::velocity, ModulationMatrix::Destination::pan, 1.0f);
+            matrix.setParameters(parameters);
+            matrix.noteOn(0.5f);
+            matrix.process(blockSize);
+            expect(matrix.isRouted(ModulationMatrix::Destination::pan));
+            expectEquals(matrix.getPanOffsets()[blockSize - 1], 0.5f);
+
+            matrix.setParameters({});
+            expect(!matrix.isRouted(ModulationMatrix::Destination::pan));
+
+            for(int i = 0; i < blockSize; i++)
+            {
+                expectEquals(matrix.getPanOffsets()[i], 0.0f);
+            }
+        }
+
+        beginTest("A note starts on its modulation rather than ramping to it");
+        {
+            ModulationMatrix::Parameters parameters;
+            route(parameters, 0, ModulationMatrix::Source::velocity, ModulationMatrix::Destination::cutoff, 0.5f);
+            route(parameters, 1, ModulationMatrix::Source::velocity, ModulationMatrix::Destination::startOffset, 0.5f);
+
+            ModulationMatrix matrix;
+            matrix.prepare(sampleRate, blockSize);
+            matrix.setParameters(parameters);
+
+            for(const float velocity : {0.8f, 0.2f})
+            {
+                matrix.noteOn(velocity);
+                matrix.process(blockSize);
+
+                const float cutoff = velocity * 0.5f * ModulationMatrix::cutoffRangeOctaves;
+                expectWithinAbsoluteError(matrix.getCutoffOctaves()[0], cutoff, 1.0e-6f);
+                expectWithinAbsoluteError(matrix.getCutoffOctaves()[blockSize - 1], cutoff, 1.0e-6f);
+                expectWithinAbsoluteError(matrix.getNoteStartOffset(), velocity * 0.5f, 1.0e-6f);
+            }
+        }
+
+        beginTest("Each ramp lands on its control point's value");
+        {
+            constexpr int interval = 8;
+            constexpr float attack = 0.05f, decay = 0.2f;
+
+            ModulationMatrix::Parameters parameters;
+            parameters.envelopeAttack = attack;
+            parameters.envelopeDecay = decay;
+            parameters.controlInterval = interval;
+            route(parameters, 0, ModulationMatrix::Source::envelope, ModulationMatrix::Destination::pan, 1.0f);
+
+            ModulationMatrix matrix;
+            matrix.prepare(sampleRate, blockSize);
+            matrix.setParameters(parameters);
+            matrix.noteOn(1.0f);
+
+            //the whole attack and decay, in blocks that don't line up with the control points
+            std::vector<float> pan;
+            const std::vector<int> blockSizes {5, 8, 13, 1, 30, blockSize};
+
+            for(int block = 0; pan.size() < 400; block++)
+            {
+                const int length = blockSizes[static_cast<size_t>(block) % blockSizes.size()];
+                matrix.process(length);
+                pan.insert(pan.end(), matrix.getPanOffsets(), matrix.getPanOffsets() + length);
+            }
+
+            auto envelopeAt = [&](int samples)
+            {
+                const float seconds = static_cast<float>(samples / sampleRate);
+                return seconds < attack ? seconds / attack : juce::jmax(0.0f, 1.0f - (seconds - attack) / decay);
+            };
+
+            float worst = 0.0f;
+
+            for(int n = 0; n < static_cast<int>(pan.size()); n++)
+            {
+                //a straight line from the last control point to the next, reaching it on the interval's last sample
+                const int point = n / interval;
+                const float from = envelopeAt(point * interval);
+                const float to = envelopeAt((point + 1) * interval);
+                const float expected = from + (to - from) * static_cast<float>(n % interval + 1) / static_cast<float>(interval);
+                worst = juce::jmax(worst, std::abs(pan[static_cast<size_t>(n)] - expected));
+            }
+
+            expectLessThan(worst, 1.0e-5f);
+            expectEquals(pan.back(), 0.0f, "the envelope has decayed away");
+        }
+
+        beginTest("A new interval waits for the next control point");
+        {
+            ModulationMatrix::Parameters parameters;
+            parameters.controlInterval = 8;
+            route(parameters, 0, ModulationMatrix::Source::lfo, ModulationMatrix::Destination::pitch, 0.5f);
+
+            ModulationMatrix matrix;
+            matrix.prepare(sampleRate, blockSize);
+            matrix.setParameters(parameters);
+            matrix.noteOn(1.0f);
+            matrix.process(3);
+
+            parameters.controlInterval = 20;
+            matrix.setParameters(parameters);
+            matrix.process(5);
+            expectEquals(matrix.getControlInterval(), 8);
+
+            matrix.process(1);
+            expectEquals(matrix.getControlInterval(), 20);
+
+            //out of range settings are held to what the ramp table covers
+            parameters.controlInterval = 100000;
+            matrix.setParameters(parameters);
+            matrix.process(blockSize);
+            expectEquals(matrix.getControlInterval(), ModulationMatrix::maxControlInterval);
+        }
+    }
+};
+
+static ModulationMatrixTests modulationMatrixTests;
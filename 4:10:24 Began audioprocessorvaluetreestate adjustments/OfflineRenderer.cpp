@@ -0,0 +1,256 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 8 Oct 2024 7:20:03pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+OfflineRenderer::OfflineRenderer(SampleChopperAudioProcessor& source, const Options& renderOptions)
+    : juce::Thread("Offline Renderer"), options(renderOptions)
+{
+    sequence = std::make_unique<SequencerEngine>();
+    sequence->copyFrom(source.getSequencerEngine());
+
+    processor = std::make_unique<SampleChopperAudioProcessor>();
+    setupProcessor(source);
+
+    //the pattern or song played numberOfLoops times, the tail is added on top
+    const double beats = sequence->getSongLengthInSteps() / sequence->getStepsPerBeat();
+    const double seconds = beats * 60.0 / sequence->getInternalBpm(); //the copy hasn't run, so its current tempo is still the default
+    patternLengthInSamples = static_cast<juce::int64>(seconds * options.sampleRate) * juce::jmax(1, options.numberOfLoops);
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    stopThread(5000);
+    processor->releaseResources();
+}
+
+void OfflineRenderer::run()
+{
+    bool ok = render();
+
+    if(threadShouldExit() && errorMessage.isEmpty())
+    {
+        ok = false;
+        errorMessage = "Bounce cancelled";
+    }
+
+    succeeded = ok;
+
+    //copied so the callback is still safe if the renderer is deleted before it runs
+    juce::MessageManager::callAsync([callback = onFinished, ok]
+    {
+        if(callback != nullptr)
+        {
+            callback(ok);
+        }
+    });
+}
+
+void OfflineRenderer::setupProcessor(SampleChopperAudioProcessor& source)
+{
+    juce::MemoryBlock state;
+    source.getStateInformation(state);
+    processor->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+    for(int i = 1; i <= 6; i++)
+    {
+        Bank* sourceBank = source.getBank(i);
+        Bank* bank = processor->getBank(i);
+        bank->setSample(sourceBank->getSample()); //shared with the live bank, never decoded again
+        bank->setLoopRegion(sourceBank->loopRegion.start(), sourceBank->loopRegion.end());
+        bank->setSliceVariants(sourceBank->getSliceVariants()); //immutable once built, so the copy can share them
+        processor->setBankTempoSync(i - 1, source.getBankTempoSync(i - 1)); //0 for the listener bank
+        bank->setInterpolation(Bank::Interpolation::hermite);
+    }
+
+    //stems come from the summing bus, so the mix and every stem are rendered in one pass
+    for(int i = 0; i < SampleChopperAudioProcessor::numberOfSampleBanks; i++)
+    {
+        processor->getSummingBus().setRoutedToStem(i, options.renderStems && !options.renderToSample);
+    }
+
+    auto& engine = processor->getSequencerEngine();
+    engine.copyFrom(*sequence); //brings the session's tempo with it
+    engine.setInternalTransportRunning(true); //no play head, so the sequencer runs from its own clock
+
+    processor->setNonRealtime(true);
+    processor->setRateAndBufferSizeDetails(options.sampleRate, options.blockSize);
+    processor->prepareToPlay(options.sampleRate, options.blockSize);
+}
+
+std::unique_ptr<juce::AudioFormatWriter> OfflineRenderer::createWriter(const juce::File& file)
+{
+    file.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+
+    if(stream->failedToOpen())
+    {
+        errorMessage = "Couldn't write to " + file.getFullPathName();
+        return nullptr;
+    }
+
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), options.sampleRate, 2, options.bitsPerSample, {}, 0));
+
+    if(writer == nullptr)
+    {
+        errorMessage = "Couldn't create a WAV writer for " + file.getFullPathName();
+        return nullptr;
+    }
+
+    stream.release(); //the writer owns the stream now
+    return writer;
+}
+
+bool OfflineRenderer::render()
+{
+    juce::Array<juce::File> files;
+
+    if(!options.renderToSample)
+    {
+        files.add(options.outputFile);
+    }
+
+    if(options.renderStems && !options.renderToSample)
+    {
+        for(int i = 0; i < SampleChopperAudioProcessor::numberOfSampleBanks; i++)
+        {
+            files.add(options.outputFile.getSiblingFile(options.outputFile.getFileNameWithoutExtension()
+                                                        + " Bank " + juce::String::charToString('A' + i) + ".wav"));
+        }
+    }
+
+    //the mix first, then one per stem
+    std::vector<std::unique_ptr<juce::AudioFormatWriter>> writers;
+
+    for(const auto& file : files)
+    {
+        writers.push_back(createWriter(file));
+
+        if(writers.back() == nullptr)
+        {
+            return false;
+        }
+    }
+
+    const juce::int64 totalSamples = patternLengthInSamples + static_cast<juce::int64>(options.tailSeconds * options.sampleRate);
+
+    //the master bus can delay the mix, the stems come before it so they don't need lining up
+    const int latency = processor->getLatencySamples();
+    const juce::int64 renderLength = totalSamples + latency;
+
+    juce::AudioBuffer<float> buffer(2, options.blockSize);
+    juce::MidiBuffer midi;
+    juce::int64 position = 0;
+
+    //the whole mix in memory, allocated up front so the loop doesn't grow it
+    juce::AudioBuffer<float> mix;
+    int mixPosition = 0;
+
+    if(options.renderToSample)
+    {
+        if(totalSamples > std::numeric_limits<int>::max() - SampleBuffer::paddingSamples)
+        {
+            errorMessage = "The pattern is too long to resample";
+            return false;
+        }
+
+        mix.setSize(2, static_cast<int>(totalSamples));
+    }
+
+    while(position < renderLength)
+    {
+        if(threadShouldExit())
+        {
+            writers.clear();
+
+            for(const auto& file : files)
+            {
+                file.deleteFile();
+            }
+
+            return false;
+        }
+
+        //blocks are cut at the end of the pattern so the sequencer stops exactly there
+        const juce::int64 blockEnd = position < patternLengthInSamples ? patternLengthInSamples : renderLength;
+        const int numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(options.blockSize), blockEnd - position));
+
+        if(position == patternLengthInSamples)
+        {
+            processor->getSequencerEngine().setInternalTransportRunning(false);
+        }
+
+        buffer.setSize(2, numSamples, false, false, true);
+        buffer.clear();
+        processor->processBlock(buffer, midi);
+
+        const int mixStart = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0), static_cast<juce::int64>(numSamples), latency - position));
+        const int stemLength = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0), static_cast<juce::int64>(numSamples), totalSamples - position));
+
+        if(mixStart < numSamples && options.renderToSample)
+        {
+            const int length = juce::jmin(numSamples - mixStart, mix.getNumSamples() - mixPosition);
+
+            for(int channel = 0; channel < 2; channel++)
+            {
+                mix.copyFrom(channel, mixPosition, buffer, channel, mixStart, length);
+            }
+
+            mixPosition += length;
+        }else if(mixStart < numSamples)
+        {
+            writers[0]->writeFromAudioSampleBuffer(buffer, mixStart, numSamples - mixStart);
+        }
+
+        for(int i = 1; i < writers.size() && stemLength > 0; i++)
+        {
+            writers[i]->writeFromAudioSampleBuffer(processor->getSummingBus().getStem(i - 1), 0, stemLength);
+        }
+
+        position += numSamples;
+        progress = static_cast<float>(position) / static_cast<float>(renderLength);
+    }
+
+    if(options.renderToSample)
+    {
+        renderedSample = new SampleBuffer(mix, options.sampleRate);
+    }
+
+    return true;
+}
+
+SampleBuffer::Ptr OfflineRenderer::getRenderedSample() const
+{
+    return succeeded ? renderedSample : nullptr;
+}
+
+BeatGrid OfflineRenderer::getRenderedBeatGrid() const
+{
+    BeatGrid grid;
+    grid.bpm = sequence->getInternalBpm();
+    grid.lengthInSeconds = patternLengthInSamples / options.sampleRate + options.tailSeconds;
+    return grid;
+}
+
+float OfflineRenderer::getProgress() const
+{
+    return progress;
+}
+
+bool OfflineRenderer::hasSucceeded() const
+{
+    return succeeded;
+}
+
+juce::String OfflineRenderer::getErrorMessage() const
+{
+    return errorMessage;
+}
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 8 Oct 2024 7:20:03pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//Bounces the current pattern (or song chain) to a WAV file, or into a new SampleBuffer, on a background thread.
+//A separate processor is built and loaded with the live one's state, samples and sequence on the message
+//thread when it's created, the thread only runs blocks through it, as fast as the CPU allows without
+//touching what's playing.
+class OfflineRenderer : public juce::Thread
+{
+public:
+    struct Options
+    {
+        juce::File outputFile;
+        double sampleRate = 44100.0;
+        int bitsPerSample = 24;
+        int blockSize = 512;
+        int numberOfLoops = 1; //times through the pattern or song
+        double tailSeconds = 2.0; //lets the last releases ring out
+        bool renderStems = false; //also writes "<name> Bank A.wav" etc. next to the mix, before the master gain
+        bool renderToSample = false; //keeps the mix in memory for getRenderedSample instead of writing any files
+    };
+
+    //message thread, copies the processor's state, samples and sequence into the one that renders
+    OfflineRenderer(SampleChopperAudioProcessor& source, const Options& options);
+    ~OfflineRenderer() override;
+
+    void run() override;
+
+    float getProgress() const;
+    bool hasSucceeded() const;
+    juce::String getErrorMessage() const; //only valid once the thread has finished
+
+    //with renderToSample, the mix once the thread has succeeded, and the grid it was played on: the
+    //sequence's tempo with the first downbeat at the start
+    SampleBuffer::Ptr getRenderedSample() const;
+    BeatGrid getRenderedBeatGrid() const;
+
+    std::function<void(bool succeeded)> onFinished; //called on the message thread
+
+private:
+
+    bool render();
+    void setupProcessor(SampleChopperAudioProcessor& source);
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(const juce::File& file);
+
+    Options options;
+
+    std::unique_ptr<SampleChopperAudioProcessor> processor; //created and destroyed on the message thread
+    std::unique_ptr<SequencerEngine> sequence;
+
+    juce::int64 patternLengthInSamples = 0;
+    SampleBuffer::Ptr renderedSample;
+
+    std::atomic<float> progress {0.0f};
+    std::atomic<bool> succeeded {false};
+    juce::String errorMessage;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    OfflineRendererTests.cpp
+    Created: 19 Oct 2024 10:12:41am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+
+class OfflineRendererTests : public juce::UnitTest
+{
+public:
+    OfflineRendererTests() : juce::UnitTest("Offline renderer", "Processor") {}
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 44100.0;
+        constexpr int blockSize = 512;
+        constexpr double bpm = 96.0; //anything but the sequencer's default of 120
+
+        //a session playing at its own tempo, run for a block so the sequencer has picked it up like it would live
+        auto source = std::make_unique<SampleChopperAudioProcessor>();
+        source->setRateAndBufferSizeDetails(sampleRate, blockSize);
+        source->prepareToPlay(sampleRate, blockSize);
+        source->getSequencerEngine().setInternalBpm(bpm);
+
+        juce::AudioBuffer<float> buffer(juce::jmax(source->getTotalNumInputChannels(), source->getTotalNumOutputChannels()), blockSize);
+        buffer.clear();
+        juce::MidiBuffer midi;
+        source->processBlock(buffer, midi);
+
+        const auto& engine = source->getSequencerEngine();
+        const double beats = engine.getSongLengthInSteps() / engine.getStepsPerBeat();
+        const auto patternSamples = static_cast<juce::int64>(beats * 60.0 / bpm * sampleRate);
+
+        beginTest("A bounce is as long as the pattern at the session's tempo");
+        {
+            const auto file = juce::File::createTempFile(".wav");
+
+            OfflineRenderer::Options options;
+            options.outputFile = file;
+            options.sampleRate = sampleRate;
+            options.blockSize = blockSize;
+            options.tailSeconds = 0.5;
+
+            {
+                OfflineRenderer renderer(*source, options);
+                renderer.startThread();
+                expect(renderer.waitForThreadToExit(60000), "the bounce finished");
+                expect(renderer.hasSucceeded(), renderer.getErrorMessage());
+            }
+
+            juce::WavAudioFormat wavFormat;
+            std::unique_ptr<juce::AudioFormatReader> reader(wavFormat.createReaderFor(new juce::FileInputStream(file), true));
+            expect(reader != nullptr, "the bounce can be read back");
+
+            if(reader != nullptr)
+            {
+                expectEquals(reader->lengthInSamples, patternSamples + static_cast<juce::int64>(options.tailSeconds * sampleRate));
+            }
+
+            reader.reset();
+            file.deleteFile();
+        }
+
+        beginTest("A resample is the pattern at the session's tempo, on a grid at that tempo");
+        {
+            //what the editor's resample button asks for
+            OfflineRenderer::Options options;
+            options.sampleRate = sampleRate;
+            options.blockSize = blockSize;
+            options.renderToSample = true;
+            options.tailSeconds = 0.0;
+
+            OfflineRenderer renderer(*source, options);
+            renderer.startThread();
+            expect(renderer.waitForThreadToExit(60000), "the resample finished");
+            expect(renderer.hasSucceeded(), renderer.getErrorMessage());
+
+            auto sample = renderer.getRenderedSample();
+            expect(sample != nullptr);
+
+            if(sample != nullptr)
+            {
+                expectEquals(static_cast<juce::int64>(sample->getNumSamples()), patternSamples);
+            }
+
+            const auto grid = renderer.getRenderedBeatGrid();
+            expectEquals(grid.bpm, bpm);
+            expectWithinAbsoluteError(grid.lengthInSeconds, beats * 60.0 / bpm, 1.0 / sampleRate);
+        }
+    }
+};
+
+static OfflineRendererTests offlineRendererTests;
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.cpp
+    Created: 14 Oct 2024 10:21:05am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "PartitionedConvolver.h"
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+    const juce::SpinLock::ScopedLockType lock(engineLock);
+    engine = nullptr;
+}
+
+void PartitionedConvolver::loadImpulseResponse(const juce::AudioBuffer<float>& impulse)
+{
+    Engine::Ptr newEngine = impulse.getNumSamples() > 0 && impulse.getNumChannels() > 0 ? new Engine(impulse) : nullptr;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(engineLock);
+        std::swap(engine, newEngine);
+        impulseLength = engine != nullptr ? engine->impulseLength : 0;
+    }
+
+    //the old engine is released here, not on the audio thread
+}
+
+void PartitionedConvolver::reset()
+{
+    const juce::SpinLock::ScopedLockType lock(engineLock);
+
+    if(engine != nullptr)
+    {
+        engine->reset();
+    }
+}
+
+void PartitionedConvolver::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), maxChannels);
+    const juce::SpinLock::ScopedTryLockType lock(engineLock);
+
+    if(!lock.isLocked() || engine == nullptr)
+    {
+        buffer.clear(0, numSamples);
+        return;
+    }
+
+    Engine& e = *engine;
+
+    //copy in and out a chunk at a time, up to the end of the partition being filled
+    for(int position = 0; position < numSamples;)
+    {
+        const int length = juce::jmin(numSamples - position, partitionSize - e.fifoPosition);
+
+        for(int channel = 0; channel < numChannels; channel++)
+        {
+            float* data = buffer.getWritePointer(channel, position);
+            float* input = e.inputs.data() + channel * fftSize + partitionSize + e.fifoPosition;
+            const float* output = e.outputs.data() + channel * partitionSize + e.fifoPosition;
+
+            juce::FloatVectorOperations::copy(input, data, length);
+            juce::FloatVectorOperations::copy(data, output, length);
+        }
+
+        e.fifoPosition += length;
+        position += length;
+
+        if(e.fifoPosition == partitionSize)
+        {
+            e.processPartition();
+            e.fifoPosition = 0;
+        }
+    }
+}
+
+//==============================================================================
+PartitionedConvolver::Engine::Engine(const juce::AudioBuffer<float>& impulse)
+{
+    numChannels = maxChannels;
+    impulseLength = impulse.getNumSamples();
+    numPartitions = (impulseLength + partitionSize - 1) / partitionSize;
+
+    const size_t spectraSize = static_cast<size_t>(numChannels) * numPartitions * numBins * 2;
+    impulseSpectra.assign(spectraSize, 0.0f);
+    inputSpectra.assign(spectraSize, 0.0f);
+    inputs.assign(static_cast<size_t>(numChannels) * fftSize, 0.0f);
+    outputs.assign(static_cast<size_t>(numChannels) * partitionSize, 0.0f);
+    work.assign(fftSize * 2, 0.0f);
+    accumulator.assign(numBins * 2, 0.0f);
+
+    //each partition zero padded to the FFT size, so the circular convolution leaves the last half clean
+    for(int channel = 0; channel < numChannels; channel++)
+    {
+        const float* source = impulse.getReadPointer(juce::jmin(channel, impulse.getNumChannels() - 1));
+
+        for(int partition = 0; partition < numPartitions; partition++)
+        {
+            const int start = partition * partitionSize;
+            const int length = juce::jmin(partitionSize, impulseLength - start);
+
+            std::fill(work.begin(), work.end(), 0.0f);
+            std::copy(source + start, source + start + length, work.begin());
+            fft.performRealOnlyForwardTransform(work.data(), true);
+
+            std::copy(work.begin(), work.begin() + numBins * 2, spectrum(impulseSpectra, channel, partition));
+        }
+    }
+}
+
+void PartitionedConvolver::Engine::reset()
+{
+    std::fill(inputSpectra.begin(), inputSpectra.end(), 0.0f);
+    std::fill(inputs.begin(), inputs.end(), 0.0f);
+    std::fill(outputs.begin(), outputs.end(), 0.0f);
+    fifoPosition = 0;
+    ringPosition = 0;
+}
+
+void PartitionedConvolver::Engine::processPartition()
+{
+    for(int channel = 0; channel < numChannels; channel++)
+    {
+        float* input = inputs.data() + channel * fftSize;
+
+        //spectrum of the last two partitions of input goes into the ring
+        std::copy(input, input + fftSize, work.begin());
+        std::fill(work.begin() + fftSize, work.end(), 0.0f);
+        fft.performRealOnlyForwardTransform(work.data(), true);
+        std::copy(work.begin(), work.begin() + numBins * 2, spectrum(inputSpectra, channel, ringPosition));
+
+        //the newest input meets the first partition of the response, the oldest meets the last
+        std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+        float* sum = accumulator.data();
+
+        for(int partition = 0; partition < numPartitions; partition++)
+        {
+            int slot = ringPosition - partition;
+            if(slot < 0)
+            {
+                slot += numPartitions;
+            }
+
+            const float* x = spectrum(inputSpectra, channel, slot);
+            const float* h = spectrum(impulseSpectra, channel, partition);
+
+            //complex multiply and add, no branches so it vectorises
+            for(int bin = 0; bin < numBins * 2; bin += 2)
+            {
+                sum[bin] += x[bin] * h[bin] - x[bin + 1] * h[bin + 1];
+                sum[bin + 1] += x[bin] * h[bin + 1] + x[bin + 1] * h[bin];
+            }
+        }
+
+        std::copy(accumulator.begin(), accumulator.end(), work.begin());
+        std::fill(work.begin() + numBins * 2, work.end(), 0.0f);
+        fft.performRealOnlyInverseTransform(work.data());
+
+        //overlap-save, only the second half is free of wrap around
+        std::copy(work.begin() + partitionSize, work.begin() + fftSize, outputs.begin() + channel * partitionSize);
+
+        //the partition just filled becomes the previous one
+        std::copy(input + partitionSize, input + fftSize, input);
+    }
+
+    ringPosition = ringPosition + 1 < numPartitions ? ringPosition + 1 : 0;
+}
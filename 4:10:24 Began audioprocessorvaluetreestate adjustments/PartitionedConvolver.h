@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.h
+    Created: 14 Oct 2024 10:21:05am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//Uniformly partitioned overlap-save FFT convolution. The impulse response is cut into partitionSize blocks
+//whose spectra are multiplied against a delay line of the last input spectra, so the cost per sample doesn't
+//depend on the host's block size and long responses stay real time. Latency is one partition.
+//
+//Everything that depends on the impulse response lives in an Engine that's built off the audio thread
+//and swapped in under a spin lock, the same way a Bank swaps its sample.
+class PartitionedConvolver
+{
+public:
+    static constexpr int partitionOrder = 8;
+    static constexpr int partitionSize = 1 << partitionOrder; //256 samples
+    static constexpr int maxChannels = 2;
+
+    ~PartitionedConvolver();
+
+    //not the audio thread, channels past the impulse's channel count reuse its last channel
+    void loadImpulseResponse(const juce::AudioBuffer<float>& impulse);
+    void reset();
+
+    //audio thread, in place on up to two channels, outputs silence while a new response is being swapped in
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+
+    int getLatencySamples() const
+    {
+        return partitionSize;
+    }
+
+    //in samples, 0 before a response is loaded, any thread without taking the lock
+    int getImpulseLength() const
+    {
+        return impulseLength.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int fftSize = partitionSize * 2;
+    static constexpr int numBins = partitionSize + 1; //non negative frequencies of a real FFT
+
+    struct Engine : public juce::ReferenceCountedObject
+    {
+        using Ptr = juce::ReferenceCountedObjectPtr<Engine>;
+
+        Engine(const juce::AudioBuffer<float>& impulse);
+
+        void reset();
+        void processPartition(); //once every partitionSize samples
+
+        float* spectrum(std::vector<float>& store, int channel, int partition)
+        {
+            return store.data() + (static_cast<size_t>(channel) * numPartitions + partition) * numBins * 2;
+        }
+
+        juce::dsp::FFT fft {partitionOrder + 1};
+        int numChannels = 0;
+        int numPartitions = 0;
+        int impulseLength = 0;
+
+        std::vector<float> impulseSpectra; //[channel][partition][bin], interleaved complex
+        std::vector<float> inputSpectra; //same layout, a ring of the last numPartitions input spectra
+        std::vector<float> inputs; //[channel][fftSize], the previous partition then the one being filled
+        std::vector<float> outputs; //[channel][partitionSize], the last result, played while the next one fills
+        std::vector<float> work; //fftSize * 2 for the in place real FFT
+        std::vector<float> accumulator; //numBins * 2
+
+        int fifoPosition = 0;
+        int ringPosition = 0;
+    };
+
+    Engine::Ptr engine;
+    juce::SpinLock engineLock;
+    std::atomic<int> impulseLength {0}; //set with each engine swap
+};
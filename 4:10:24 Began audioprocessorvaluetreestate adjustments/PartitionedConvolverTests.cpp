@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolverTests.cpp
+    Created: 18 Oct 2024 2:02:48pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PartitionedConvolver.h"
+
+class PartitionedConvolverTests : public juce::UnitTest
+{
+public:
+    PartitionedConvolverTests() : juce::UnitTest("Partitioned convolver", "Effects") {}
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        auto fillWithNoise = [&random](juce::AudioBuffer<float>& buffer)
+        {
+            for(int channel = 0; channel < buffer.getNumChannels(); channel++)
+            {
+                for(int i = 0; i < buffer.getNumSamples(); i++)
+                {
+                    buffer.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+                }
+            }
+        };
+
+        //a response that doesn't fill its last partition, and input played through in uneven blocks
+        juce::AudioBuffer<float> impulse(2, 3 * PartitionedConvolver::partitionSize + 101);
+        juce::AudioBuffer<float> input(2, 4000);
+        fillWithNoise(impulse);
+        fillWithNoise(input);
+        impulse.applyGain(0.05f); //keeps the output near unity
+
+        const std::vector<int> blockSizes {1, 100, 37, 256, 511, 64, 1000};
+
+        auto render = [&](PartitionedConvolver& convolver)
+        {
+            juce::AudioBuffer<float> output(input);
+
+            for(int position = 0, block = 0; position < output.getNumSamples(); block++)
+            {
+                const int length = juce::jmin(blockSizes[static_cast<size_t>(block) % blockSizes.size()], output.getNumSamples() - position);
+                juce::AudioBuffer<float> view(output.getArrayOfWritePointers(), output.getNumChannels(), position, length);
+                convolver.process(view, length);
+                position += length;
+            }
+
+            return output;
+        };
+
+        //the direct sum, delayed by the convolver's latency
+        auto directError = [&](const juce::AudioBuffer<float>& output, const juce::AudioBuffer<float>& response)
+        {
+            const int latency = PartitionedConvolver::partitionSize;
+            float worst = 0.0f;
+
+            for(int channel = 0; channel < output.getNumChannels(); channel++)
+            {
+                const float* h = response.getReadPointer(juce::jmin(channel, response.getNumChannels() - 1));
+                const float* x = input.getReadPointer(channel);
+
+                for(int n = 0; n < output.getNumSamples(); n++)
+                {
+                    double expected = 0.0;
+
+                    for(int k = 0; k < response.getNumSamples() && k <= n - latency; k++)
+                    {
+                        expected += static_cast<double>(h[k]) * x[n - latency - k];
+                    }
+
+                    worst = juce::jmax(worst, std::abs(output.getSample(channel, n) - static_cast<float>(expected)));
+                }
+            }
+
+            return worst;
+        };
+
+        beginTest("Outputs silence before a response is loaded");
+        {
+            PartitionedConvolver convolver;
+            expectEquals(convolver.getImpulseLength(), 0);
+            expectEquals(render(convolver).getMagnitude(0, input.getNumSamples()), 0.0f);
+        }
+
+        beginTest("Matches direct convolution, one partition late");
+        {
+            PartitionedConvolver convolver;
+            convolver.loadImpulseResponse(impulse);
+            expectEquals(convolver.getImpulseLength(), impulse.getNumSamples());
+            expectLessThan(directError(render(convolver), impulse), 1.0e-4f);
+        }
+
+        beginTest("A mono response is used on both channels");
+        {
+            juce::AudioBuffer<float> mono(1, impulse.getNumSamples());
+            mono.copyFrom(0, 0, impulse, 0, 0, impulse.getNumSamples());
+
+            PartitionedConvolver convolver;
+            convolver.loadImpulseResponse(mono);
+            expectLessThan(directError(render(convolver), mono), 1.0e-4f);
+        }
+
+        beginTest("Reset clears the tail");
+        {
+            PartitionedConvolver convolver;
+            convolver.loadImpulseResponse(impulse);
+            render(convolver);
+            convolver.reset();
+
+            juce::AudioBuffer<float> silence(2, 2000);
+            silence.clear();
+            convolver.process(silence, silence.getNumSamples());
+            expectEquals(silence.getMagnitude(0, silence.getNumSamples()), 0.0f);
+        }
+    }
+};
+
+static PartitionedConvolverTests partitionedConvolverTests;
@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    Pattern.cpp
+    Created: 6 Oct 2024 1:12:37pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "Pattern.h"
+
+Pattern::Pattern()
+{
+    clear();
+}
+
+void Pattern::setStep(int bank, int step, bool isOn)
+{
+    if(!juce::isPositiveAndBelow(bank, numberOfBanks) || !juce::isPositiveAndBelow(step, maxSteps))
+    {
+        return;
+    }
+
+    const juce::uint32 bankBit = 1u << bank;
+
+    if(isOn)
+    {
+        triggerMasks[step].fetch_or(bankBit);
+    }else
+    {
+        triggerMasks[step].fetch_and(~bankBit);
+    }
+}
+
+bool Pattern::getStep(int bank, int step) const
+{
+    if(!juce::isPositiveAndBelow(bank, numberOfBanks) || !juce::isPositiveAndBelow(step, maxSteps))
+    {
+        return false;
+    }
+
+    return (getTriggerMask(step) & (1u << bank)) != 0;
+}
+
+void Pattern::setStepData(int bank, int step, StepData data)
+{
+    if(juce::isPositiveAndBelow(bank, numberOfBanks) && juce::isPositiveAndBelow(step, maxSteps))
+    {
+        data.microTiming = static_cast<juce::int8>(juce::jlimit(-StepData::maxMicroTiming, StepData::maxMicroTiming, static_cast<int>(data.microTiming)));
+        data.probability = juce::jmin(data.probability, static_cast<juce::uint8>(100));
+        data.velocity = juce::jmin(data.velocity, static_cast<juce::uint8>(127));
+
+        stepData[bank][step] = data.pack();
+    }
+}
+
+StepData Pattern::getStepData(int bank, int step) const
+{
+    if(juce::isPositiveAndBelow(bank, numberOfBanks) && juce::isPositiveAndBelow(step, maxSteps))
+    {
+        return StepData::unpack(stepData[bank][step].load(std::memory_order_relaxed));
+    }
+
+    return {};
+}
+
+void Pattern::setStepLocks(int bank, int step, const StepLocks& locks)
+{
+    if(juce::isPositiveAndBelow(bank, numberOfBanks) && juce::isPositiveAndBelow(step, maxSteps))
+    {
+        stepLocks[bank][step] = locks.pack();
+    }
+}
+
+StepLocks Pattern::getStepLocks(int bank, int step) const
+{
+    if(juce::isPositiveAndBelow(bank, numberOfBanks) && juce::isPositiveAndBelow(step, maxSteps))
+    {
+        return StepLocks::unpack(stepLocks[bank][step].load(std::memory_order_relaxed));
+    }
+
+    return {};
+}
+
+void Pattern::setSwing(int percent)
+{
+    swing = juce::jlimit(minSwing, maxSwing, percent);
+}
+
+int Pattern::getSwing() const
+{
+    return swing;
+}
+
+double Pattern::getSwingOffset() const
+{
+    return (getSwing() - minSwing) / 50.0;
+}
+
+void Pattern::setLength(int steps)
+{
+    length = juce::jlimit(1, maxSteps, steps);
+}
+
+int Pattern::getLength() const
+{
+    return length;
+}
+
+bool Pattern::isEmpty() const
+{
+    for(const auto& mask : triggerMasks)
+    {
+        if(mask.load() != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Pattern::clear()
+{
+    const juce::uint32 defaultData = StepData().pack();
+    const juce::uint64 defaultLocks = StepLocks().pack();
+
+    for(auto& mask : triggerMasks)
+    {
+        mask = 0;
+    }
+
+    for(auto& bankSteps : stepData)
+    {
+        for(auto& data : bankSteps)
+        {
+            data = defaultData;
+        }
+    }
+
+    for(auto& bankSteps : stepLocks)
+    {
+        for(auto& locks : bankSteps)
+        {
+            locks = defaultLocks;
+        }
+    }
+
+    length = 16;
+    swing = minSwing;
+}
+
+void Pattern::copyFrom(const Pattern& other)
+{
+    for(int step = 0; step < maxSteps; step++)
+    {
+        triggerMasks[step] = other.triggerMasks[step].load();
+
+        for(int bank = 0; bank < numberOfBanks; bank++)
+        {
+            stepData[bank][step] = other.stepData[bank][step].load();
+            stepLocks[bank][step] = other.stepLocks[bank][step].load();
+        }
+    }
+
+    length = other.getLength();
+    swing = other.getSwing();
+}
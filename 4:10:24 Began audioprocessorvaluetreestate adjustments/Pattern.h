@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    Pattern.h
+    Created: 6 Oct 2024 1:12:37pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Bank.h"
+
+//velocity, probability and micro-timing for one bank on one step, packed into a single word
+struct StepData
+{
+    juce::uint8 velocity = 127;
+    juce::uint8 probability = 100; //percent
+    juce::int8 microTiming = 0; //ticks, StepData::ticksPerStep to a step
+
+    static constexpr int ticksPerStep = 24;
+    static constexpr int maxMicroTiming = ticksPerStep / 2; //up to half a step early or late
+
+    juce::uint32 pack() const
+    {
+        return static_cast<juce::uint32>(velocity)
+             | (static_cast<juce::uint32>(probability) << 8)
+             | (static_cast<juce::uint32>(static_cast<juce::uint8>(microTiming)) << 16);
+    }
+
+    static StepData unpack(juce::uint32 word)
+    {
+        StepData data;
+        data.velocity = static_cast<juce::uint8>(word & 0xff);
+        data.probability = static_cast<juce::uint8>((word >> 8) & 0xff);
+        data.microTiming = static_cast<juce::int8>((word >> 16) & 0xff);
+        return data;
+    }
+};
+
+//One sequencer pattern of up to 256 steps.
+//Each bank's steps are a bitset, interleaved so that bit b of a step's word is bank b,
+//which lets the audio thread see everything that fires on a step with one load.
+class Pattern
+{
+public:
+    Pattern();
+
+    static constexpr int maxSteps = 256;
+    static constexpr int maxBanks = 32; //one bit per bank in a step's word
+    static constexpr int numberOfBanks = 5;
+
+    void setStep(int bank, int step, bool isOn);
+    bool getStep(int bank, int step) const;
+
+    juce::uint32 getTriggerMask(int step) const
+    {
+        return triggerMasks[step].load(std::memory_order_relaxed);
+    }
+
+    void setStepData(int bank, int step, StepData data);
+    StepData getStepData(int bank, int step) const;
+
+    void setStepLocks(int bank, int step, const StepLocks& locks);
+    StepLocks getStepLocks(int bank, int step) const;
+
+    //50 is straight, 75 pushes every second step half a step late
+    void setSwing(int percent);
+    int getSwing() const;
+    double getSwingOffset() const; //in steps, for the odd steps
+    static constexpr int minSwing = 50;
+    static constexpr int maxSwing = 75;
+
+    void setLength(int steps);
+    int getLength() const;
+
+    bool isEmpty() const;
+    void clear();
+    void copyFrom(const Pattern& other);
+
+private:
+    std::array<std::atomic<juce::uint32>, maxSteps> triggerMasks;
+    std::array<std::array<std::atomic<juce::uint32>, maxSteps>, numberOfBanks> stepData;
+    std::array<std::array<std::atomic<juce::uint64>, maxSteps>, numberOfBanks> stepLocks;
+    std::atomic<int> length {16};
+    std::atomic<int> swing {minSwing};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Pattern)
+};
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    PatternTests.cpp
+    Created: 18 Oct 2024 11:20:14am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SequencerEngine.h"
+
+class PatternTests : public juce::UnitTest
+{
+public:
+    PatternTests() : juce::UnitTest("Pattern", "Sequencer") {}
+
+    void runTest() override
+    {
+        beginTest("Steps set and clear only their own bank's bit");
+        {
+            auto pattern = std::make_unique<Pattern>(); //too big for the stack
+            expect(pattern->isEmpty());
+
+            auto isSet = [](int bank, int step) { return (bank * 37 + step) % 3 == 0; };
+
+            for(int bank = 0; bank < Pattern::numberOfBanks; bank++)
+            {
+                for(int step = 0; step < Pattern::maxSteps; step++)
+                {
+                    pattern->setStep(bank, step, isSet(bank, step));
+                }
+            }
+
+            bool allMatch = true;
+
+            for(int step = 0; step < Pattern::maxSteps; step++)
+            {
+                juce::uint32 expectedMask = 0;
+
+                for(int bank = 0; bank < Pattern::numberOfBanks; bank++)
+                {
+                    allMatch &= pattern->getStep(bank, step) == isSet(bank, step);
+                    expectedMask |= isSet(bank, step) ? 1u << bank : 0u;
+                }
+
+                allMatch &= pattern->getTriggerMask(step) == expectedMask;
+            }
+
+            expect(allMatch, "every step reads back as it was set, one bit per bank");
+
+            pattern->setStep(2, 9, false);
+            pattern->setStep(3, 9, true);
+            expect(!pattern->getStep(2, 9));
+            expect(pattern->getStep(3, 9));
+            expect(pattern->getStep(0, 9) == isSet(0, 9) && pattern->getStep(4, 9) == isSet(4, 9), "neighbouring banks are untouched");
+
+            pattern->clear();
+            expect(pattern->isEmpty());
+        }
+
+        beginTest("Steps outside the pattern are ignored");
+        {
+            auto pattern = std::make_unique<Pattern>();
+            pattern->setStep(Pattern::numberOfBanks, 0, true);
+            pattern->setStep(-1, 0, true);
+            pattern->setStep(0, Pattern::maxSteps, true);
+            expect(pattern->isEmpty());
+            expect(!pattern->getStep(0, -1));
+            expect(!pattern->getStep(Pattern::numberOfBanks, 0));
+        }
+
+        beginTest("A song chain plays each pattern for its own length");
+        {
+            //120bpm at 48kHz in 1/16 notes is exactly 6000 samples a step, so each block is one step
+            constexpr double sampleRate = 48000.0;
+            constexpr int samplesPerStep = 6000;
+
+            auto engine = std::make_unique<SequencerEngine>();
+            engine->prepareToPlay(sampleRate);
+            engine->setInternalBpm(120.0);
+            engine->setStepsPerBeat(4.0);
+
+            const std::vector<int> chain {1, 0, 2, 0};
+
+            for(auto index : chain)
+            {
+                engine->appendToChain(index);
+            }
+
+            //lengths changed after the chain was built, the song has to follow them
+            const std::array<int, 3> lengths {4, 3, 5};
+
+            for(int index = 0; index < 3; index++)
+            {
+                engine->setSelectedPattern(index);
+                engine->setStepsPerSequence(lengths[static_cast<size_t>(index)]);
+            }
+
+            engine->setSelectedPattern(0);
+            engine->setSongMode(true);
+            expectEquals(engine->getSongLengthInSteps(), 3 + 4 + 5 + 4);
+
+            engine->getPattern(2).setStep(3, 4, true); //the last step of pattern 2, steps 11 and 27 of the song
+
+            std::vector<std::pair<int, int>> expected; //pattern and step in pattern for each step of the song
+
+            for(auto index : chain)
+            {
+                for(int step = 0; step < lengths[static_cast<size_t>(index)]; step++)
+                {
+                    expected.emplace_back(index, step);
+                }
+            }
+
+            std::vector<BankEvent> events;
+            events.reserve(16);
+            engine->setInternalTransportRunning(true);
+
+            bool allLocated = true;
+            std::vector<int> triggeredSteps;
+
+            for(int step = 0; step < 2 * static_cast<int>(expected.size()); step++)
+            {
+                events.clear();
+                engine->processBlock(nullptr, samplesPerStep, events);
+
+                const auto& location = expected[static_cast<size_t>(step) % expected.size()];
+                allLocated &= engine->getPlayingPattern() == location.first && engine->getCurrentStep() == location.second;
+
+                for(const auto& event : events)
+                {
+                    if(event.bankIndex == 3)
+                    {
+                        triggeredSteps.push_back(step);
+                    }
+                }
+            }
+
+            expect(allLocated, "every step lands on the right pattern and step, twice round the song");
+            expect(triggeredSteps == std::vector<int> {11, 27}, "pattern 2's last step fires once each time round");
+
+            //switched off the chain plays the selected pattern on its own
+            engine->setSongMode(false);
+            events.clear();
+            engine->processBlock(nullptr, samplesPerStep, events);
+            expectEquals(engine->getPlayingPattern(), 0);
+            expectEquals(engine->getCurrentStep(), (2 * static_cast<int>(expected.size())) % lengths[0]);
+        }
+    }
+};
+
+static PatternTests patternTests;
@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    PerformanceMeter.cpp
+    Created: 11 Oct 2024 4:02:55pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PerformanceMeter.h"
+
+//==============================================================================
+PerformanceMeter::PerformanceMeter(PerformanceMonitor& performanceMonitor) : monitor(performanceMonitor)
+{
+    addAndMakeVisible(enableButton);
+    enableButton.addListener(this);
+    enableButton.setToggleState(monitor.isEnabled(), juce::dontSendNotification);
+
+    addAndMakeVisible(resetButton);
+    resetButton.addListener(this);
+
+    addAndMakeVisible(exportButton);
+    exportButton.addListener(this);
+
+    startTimerHz(10);
+}
+
+PerformanceMeter::~PerformanceMeter()
+{
+    stopTimer();
+}
+
+void PerformanceMeter::paint (juce::Graphics& g)
+{
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+
+    auto area = getLocalBounds().withTrimmedTop(getHeight() / 4);
+
+    if(!monitor.isEnabled())
+    {
+        g.setColour(juce::Colours::grey);
+        g.drawText("Collection off", area, juce::Justification::centred);
+        return;
+    }
+
+    //load, worst block and overruns
+    auto textArea = area.removeFromTop(area.getHeight() / 3);
+    g.setColour(snapshot.worstLoad > 1.0f ? juce::Colours::red : juce::Colours::white);
+    g.drawText("Load " + juce::String(snapshot.lastLoad * 100.0f, 0) + "%  avg " + juce::String(snapshot.averageLoad * 100.0f, 0)
+               + "%  worst " + juce::String(snapshot.worstLoad * 100.0f, 0) + "%  overruns " + juce::String(snapshot.overruns),
+               textArea, juce::Justification::centredLeft);
+
+    //stage breakdown
+    auto stageArea = area.removeFromTop(area.getHeight() / 2);
+    juce::String stages;
+    for(int stage = 0; stage < PerformanceMonitor::numberOfStages; stage++)
+    {
+        stages << PerformanceMonitor::getStageName(static_cast<PerformanceMonitor::Stage>(stage)) << " "
+               << juce::String(snapshot.averageStageMicroseconds[stage], 1) << "us  ";
+    }
+    g.setColour(juce::Colours::lightgrey);
+    g.drawText(stages, stageArea, juce::Justification::centredLeft);
+
+    //histogram of block load, the bar at 100% is the deadline
+    juce::uint32 tallest = 1;
+    for(auto count : snapshot.histogram)
+    {
+        tallest = juce::jmax(tallest, count);
+    }
+
+    const float barWidth = static_cast<float>(area.getWidth()) / PerformanceMonitor::numberOfBuckets;
+
+    for(int i = 0; i < PerformanceMonitor::numberOfBuckets; i++)
+    {
+        const float barHeight = area.getHeight() * static_cast<float>(snapshot.histogram[i]) / tallest;
+        const bool overDeadline = i * PerformanceMonitor::bucketWidth >= 1.0f;
+
+        g.setColour(overDeadline ? juce::Colours::red : juce::Colours::green);
+        g.fillRect(area.getX() + i * barWidth, area.getBottom() - barHeight, barWidth - 1.0f, barHeight);
+    }
+}
+
+void PerformanceMeter::resized()
+{
+    int buttonWidth = getWidth() / 3;
+
+    enableButton.setBounds(0, 0, buttonWidth, getHeight() / 4);
+    resetButton.setBounds(buttonWidth, 0, buttonWidth, getHeight() / 4);
+    exportButton.setBounds(buttonWidth * 2, 0, buttonWidth, getHeight() / 4);
+}
+
+void PerformanceMeter::timerCallback()
+{
+    if(monitor.isEnabled())
+    {
+        snapshot = monitor.getSnapshot();
+        repaint();
+    }
+}
+
+void PerformanceMeter::buttonClicked(juce::Button *button)
+{
+    if(&enableButton == button)
+    {
+        monitor.setEnabled(enableButton.getToggleState());
+        repaint();
+    }
+
+    if(&resetButton == button)
+    {
+        monitor.reset();
+    }
+
+    if(&exportButton == button)
+    {
+        juce::FileChooser chooser("Export performance data...", juce::File(), "*.json");
+        if(chooser.browseForFileToSave(true))
+        {
+            chooser.getResult().withFileExtension("json").replaceWithText(juce::JSON::toString(monitor.toJSON()));
+        }
+    }
+}
@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    PerformanceMeter.h
+    Created: 11 Oct 2024 4:02:55pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PerformanceMonitor.h"
+
+//==============================================================================
+/*
+    Shows the processor's block load and stage timings from the PerformanceMonitor,
+    with buttons to turn collection on, reset it and export it as JSON.
+*/
+class PerformanceMeter  : public juce::Component, public juce::Timer, public juce::Button::Listener
+{
+public:
+    PerformanceMeter(PerformanceMonitor& monitor);
+    ~PerformanceMeter() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+    void timerCallback() override;
+    void buttonClicked(juce::Button *button) override;
+
+private:
+
+    PerformanceMonitor& monitor;
+    PerformanceMonitor::Snapshot snapshot;
+
+    juce::ToggleButton enableButton{"CPU"};
+    juce::TextButton resetButton{"Reset"};
+    juce::TextButton exportButton{"Export"};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PerformanceMeter)
+};
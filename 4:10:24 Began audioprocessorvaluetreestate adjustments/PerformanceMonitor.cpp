@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.cpp
+    Created: 11 Oct 2024 3:26:18pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "PerformanceMonitor.h"
+
+void PerformanceMonitor::setEnabled(bool shouldBeEnabled)
+{
+    enabled = shouldBeEnabled;
+}
+
+bool PerformanceMonitor::isEnabled() const
+{
+    return enabled;
+}
+
+void PerformanceMonitor::prepare(double sampleRate)
+{
+    currentSampleRate = sampleRate;
+    reset();
+}
+
+void PerformanceMonitor::reset()
+{
+    for(auto& bucket : histogram)
+    {
+        bucket = 0;
+    }
+
+    for(auto& ticks : stageTicks)
+    {
+        ticks = 0;
+    }
+
+    blockCount = 0;
+    overrunCount = 0;
+    totalLoad = 0.0;
+    lastLoad = 0.0f;
+    worstLoad = 0.0f;
+}
+
+void PerformanceMonitor::beginBlock(int numSamples)
+{
+    measuringBlock = enabled.load(std::memory_order_relaxed); //a block is measured all or nothing
+
+    if(measuringBlock)
+    {
+        blockNumSamples = numSamples;
+        blockStartTicks = juce::Time::getHighResolutionTicks();
+        stageStartTicks = blockStartTicks;
+    }
+}
+
+void PerformanceMonitor::endStage(Stage stage)
+{
+    if(measuringBlock)
+    {
+        const auto now = juce::Time::getHighResolutionTicks();
+        stageTicks[stage].fetch_add(now - stageStartTicks, std::memory_order_relaxed);
+        stageStartTicks = now;
+    }
+}
+
+void PerformanceMonitor::endBlock()
+{
+    if(!measuringBlock || blockNumSamples <= 0)
+    {
+        return;
+    }
+
+    const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - blockStartTicks);
+    const double deadline = blockNumSamples / currentSampleRate.load(std::memory_order_relaxed);
+    const auto load = static_cast<float>(seconds / deadline);
+
+    const int bucket = juce::jlimit(0, numberOfBuckets - 1, static_cast<int>(load / bucketWidth));
+    histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    if(load > 1.0f)
+    {
+        overrunCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //only this thread writes these, so a plain load and store is enough
+    totalLoad.store(totalLoad.load(std::memory_order_relaxed) + load, std::memory_order_relaxed);
+    lastLoad.store(load, std::memory_order_relaxed);
+
+    if(load > worstLoad.load(std::memory_order_relaxed))
+    {
+        worstLoad.store(load, std::memory_order_relaxed);
+    }
+
+    blockCount.fetch_add(1, std::memory_order_release);
+}
+
+PerformanceMonitor::Snapshot PerformanceMonitor::getSnapshot() const
+{
+    Snapshot snapshot;
+    snapshot.blocks = blockCount.load(std::memory_order_acquire);
+    snapshot.overruns = overrunCount;
+    snapshot.lastLoad = lastLoad;
+    snapshot.worstLoad = worstLoad;
+
+    for(int i = 0; i < numberOfBuckets; i++)
+    {
+        snapshot.histogram[i] = histogram[i];
+    }
+
+    if(snapshot.blocks > 0)
+    {
+        snapshot.averageLoad = static_cast<float>(totalLoad / snapshot.blocks);
+
+        for(int stage = 0; stage < numberOfStages; stage++)
+        {
+            snapshot.averageStageMicroseconds[stage] = juce::Time::highResolutionTicksToSeconds(stageTicks[stage]) * 1.0e6 / snapshot.blocks;
+        }
+    }
+
+    return snapshot;
+}
+
+juce::var PerformanceMonitor::toJSON() const
+{
+    const auto snapshot = getSnapshot();
+
+    auto* stages = new juce::DynamicObject();
+    for(int stage = 0; stage < numberOfStages; stage++)
+    {
+        stages->setProperty(getStageName(static_cast<Stage>(stage)), snapshot.averageStageMicroseconds[stage]);
+    }
+
+    juce::Array<juce::var> buckets;
+    for(auto count : snapshot.histogram)
+    {
+        buckets.add(static_cast<juce::int64>(count));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("sampleRate", currentSampleRate.load());
+    root->setProperty("blocks", snapshot.blocks);
+    root->setProperty("overruns", snapshot.overruns);
+    root->setProperty("averageLoad", snapshot.averageLoad);
+    root->setProperty("worstLoad", snapshot.worstLoad);
+    root->setProperty("averageStageMicroseconds", juce::var(stages));
+    root->setProperty("histogramBucketWidth", bucketWidth);
+    root->setProperty("loadHistogram", buckets);
+    return juce::var(root);
+}
+
+juce::String PerformanceMonitor::getStageName(Stage stage)
+{
+    switch(stage)
+    {
+        case sequencer: return "sequencer";
+        case voices: return "voices";
+        case mix: return "mix";
+        default: return {};
+    }
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.h
+    Created: 11 Oct 2024 3:26:18pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//Times each processBlock against its deadline (numSamples / sampleRate) with a breakdown per stage.
+//The audio thread only writes atomics, the GUI reads them whenever it likes.
+//When disabled a block costs one relaxed load of the enabled flag.
+class PerformanceMonitor
+{
+public:
+    enum Stage
+    {
+        sequencer, //MIDI, sequencer and sorting the events
+        voices, //rendering the banks
+        mix, //master gain and anything after the banks
+        numberOfStages
+    };
+
+    //load histogram, 5% per bucket, the last bucket holds everything from 195% up
+    static constexpr int numberOfBuckets = 40;
+    static constexpr float bucketWidth = 0.05f;
+
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const;
+
+    void prepare(double sampleRate);
+    void reset(); //message thread, clears everything collected so far
+
+    //audio thread
+    void beginBlock(int numSamples);
+    void endStage(Stage stage); //time since the last stage (or the start of the block) goes to this stage
+    void endBlock();
+
+    struct Snapshot
+    {
+        juce::int64 blocks = 0;
+        juce::int64 overruns = 0; //blocks that took longer than their deadline
+        float lastLoad = 0.0f;
+        float worstLoad = 0.0f;
+        float averageLoad = 0.0f;
+        std::array<double, numberOfStages> averageStageMicroseconds {};
+        std::array<juce::uint32, numberOfBuckets> histogram {};
+    };
+
+    Snapshot getSnapshot() const;
+    juce::var toJSON() const;
+
+    static juce::String getStageName(Stage stage);
+
+private:
+    std::atomic<bool> enabled {false};
+
+    std::array<std::atomic<juce::uint32>, numberOfBuckets> histogram {};
+    std::array<std::atomic<juce::int64>, numberOfStages> stageTicks {};
+    std::atomic<juce::int64> blockCount {0};
+    std::atomic<juce::int64> overrunCount {0};
+    std::atomic<double> totalLoad {0.0};
+    std::atomic<float> lastLoad {0.0f};
+    std::atomic<float> worstLoad {0.0f};
+    std::atomic<double> currentSampleRate {44100.0};
+
+    //audio thread only
+    bool measuringBlock = false;
+    juce::int64 blockStartTicks = 0;
+    juce::int64 stageStartTicks = 0;
+    int blockNumSamples = 0;
+};
@@ -46,12 +46,24 @@ SampleChopperAudioProcessorEditor::SampleChopperAudioProcessorEditor (SampleChop
     addAndMakeVisible(listenerBankStop);
     listenerBankStop.addListener(this);
     
+    addAndMakeVisible(bounceButton);
+    bounceButton.addListener(this);
+    addAndMakeVisible(bounceStemsButton);
+    
+    addAndMakeVisible(recordButton);
+    recordButton.addListener(this);
+    
+    addAndMakeVisible(resampleButton);
+    resampleButton.addListener(this);
+    
     //pitch slider that effects the entire track
     addAndMakeVisible(globalPitchSlider);
-    globalPitchSlider.addListener(this);
+    globalPitchAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "globalSpeed", globalPitchSlider);
     
     addAndMakeVisible(showTransientsButton);
     showTransientsButton.addListener(this);
+    showTransientsButton.setClickingTogglesState(true);
+    showTransientsAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "Transients tog", showTransientsButton);
     
     addAndMakeVisible(transientSensitivitySlider);
     transientSensitivitySlider.addListener(this);
@@ -66,6 +78,51 @@ SampleChopperAudioProcessorEditor::SampleChopperAudioProcessorEditor (SampleChop
     transientWindowSizeSlider.setNumDecimalPlacesToDisplay(0);
 
     
+    //cuts the file along the beat grid into banks A to E, from wherever the waveform is scrolled to
+    addAndMakeVisible(sliceButton);
+    sliceButton.addListener(this);
+    addAndMakeVisible(sliceDivisionSelector);
+    sliceDivisionSelector.addItem("1/4", 1);
+    sliceDivisionSelector.addItem("1/8", 2);
+    sliceDivisionSelector.addItem("1/16", 4);
+    sliceDivisionSelector.setSelectedId(4, juce::dontSendNotification);
+    
+    addAndMakeVisible(addVariantButton);
+    addVariantButton.addListener(this);
+    addAndMakeVisible(variantLayerSelector);
+    
+    for(int layer = 0; layer < SliceVariants::numberOfLayers; layer++)
+    {
+        variantLayerSelector.addItem("Layer " + juce::String(layer + 1), layer + 1);
+    }
+    
+    variantLayerSelector.setSelectedId(1, juce::dontSendNotification);
+    
+    addAndMakeVisible(variantPolicySelector);
+    variantPolicySelector.addItem("Round Robin", 1);
+    variantPolicySelector.addItem("Random", 2);
+    variantPolicySelector.setSelectedId(1, juce::dontSendNotification);
+    variantPolicySelector.onChange = [this] { setVariantPolicy(); };
+    
+    addAndMakeVisible(clearVariantsButton);
+    clearVariantsButton.addListener(this);
+    addAndMakeVisible(variantsLabel);
+    updateVariantControls();
+    
+    addAndMakeVisible(undoButton);
+    undoButton.addListener(this);
+    addAndMakeVisible(redoButton);
+    redoButton.addListener(this);
+    audioProcessor.undoManager.addChangeListener(this);
+    changeListenerCallback(&audioProcessor.undoManager);
+    setWantsKeyboardFocus(true);
+    
+    addAndMakeVisible(snapSelector);
+    snapSelector.addItem("Snap Off", snapOff);
+    snapSelector.addItem("Snap Bar", snapBar);
+    snapSelector.addItem("Snap Beat", snapBeat);
+    snapSelector.setSelectedId(snapOff, juce::dontSendNotification);
+    
     //waveform display
     addAndMakeVisible(waveformDisplay);
     
@@ -75,6 +132,11 @@ SampleChopperAudioProcessorEditor::SampleChopperAudioProcessorEditor (SampleChop
     });
     waveformDisplay.setColours(myColours); //gives the waveform object the colours used for bank selection
     
+    if(!showTransientsButton.getToggleState())
+    {
+        waveformDisplay.hideTransients();
+    }
+    
     
     
     //Bank selector Buttons
@@ -107,21 +169,22 @@ SampleChopperAudioProcessorEditor::SampleChopperAudioProcessorEditor (SampleChop
     
     waveformDisplay.setBankSelected(bankSelected);
     
+    //a grid found before the editor was opened, the sequencer keeps whatever tempo it's already on
+    beatGrid = audioProcessor.getSampleAnalyser().getBeatGrid();
+    beatGridVersion = audioProcessor.getSampleAnalyser().getVersion();
+    waveformDisplay.setBeatGrid(beatGrid);
+    sampleVersion = audioProcessor.getSampleVersion();
+    
     addAndMakeVisible(sequencer);
     
-    sequencer.triggerSample = ([this, banksList](int bank) //when the sequencer calls triggers sample it will play that bank from the editor
-    {
-        if(banksList[bank]->loopRegion.proper())
-        {
-            banksList[bank]->play();
-        }
-    });
+    addAndMakeVisible(performanceMeter);
     
     
 }
 
 SampleChopperAudioProcessorEditor::~SampleChopperAudioProcessorEditor()
 {
+    audioProcessor.undoManager.removeChangeListener(this);
     
     //Assigning pointer vectors to nullptr - freeing memory
     for(int i = 0; i < guiList.size(); i++)
@@ -140,6 +203,7 @@ SampleChopperAudioProcessorEditor::~SampleChopperAudioProcessorEditor()
     }
     
     stopTimer();
+    offlineRenderer = nullptr; //waits for a bounce in progress to stop
     
 }
 
@@ -172,14 +236,34 @@ void SampleChopperAudioProcessorEditor::resized()
     
     listenerBankPlay.setBounds(0, 0, getWidth() / 10, getHeight() / 20);
     listenerBankStop.setBounds(getWidth() / 10, 0, getWidth() / 10, getHeight() / 20);
+    bounceButton.setBounds((getWidth() / 10) * 2, 0, getWidth() / 10, getHeight() / 20);
+    bounceStemsButton.setBounds((getWidth() / 10) * 3, 0, getWidth() / 20, getHeight() / 20);
     loadButton.setBounds((getWidth() / 14) * 7.5,0,(getWidth()/14) * 2, getHeight() / 20);
     globalPitchSlider.setBounds((getWidth() / 14) * 5, 0, (getWidth() / 14) * 2, getHeight() / 20);
     
     waveformDisplay.setBounds((getWidth() / 20) * 2,(getHeight() / 20) * 1.25, (getWidth() / 20) * 16, (getHeight() / 10) * 2.5);
     
     showTransientsButton.setBounds((getWidth() / 14) * 11, 0, (getWidth() / 14) * 2, getHeight() / 20);
+    recordButton.setBounds((getWidth() / 14) * 13, 0, getWidth() / 14, getHeight() / 20);
+    snapSelector.setBounds((getWidth() / 14) * 9.6, 0, (getWidth() / 14) * 1.3, getHeight() / 20);
     transientSensitivitySlider.setBounds((getWidth() / 20) * 18, (getHeight() / 20) * 1.75, (getWidth() / 20) * 2, (getHeight() / 20) * 2);
     transientWindowSizeSlider.setBounds((getWidth() / 20) * 18, (getHeight() / 20) * 3.75, (getWidth() / 20) * 2, (getHeight() / 20) * 2);
+    sliceButton.setBounds(0, (getHeight() / 20) * 1.75, (getWidth() / 20) * 2, getHeight() / 20);
+    sliceDivisionSelector.setBounds(0, (getHeight() / 20) * 3.75, (getWidth() / 20) * 2, getHeight() / 20);
+    undoButton.setBounds(0, (getHeight() / 20) * 5, getWidth() / 20, getHeight() / 20);
+    
+    //strip between the waveform and the banks
+    const int variantY = (getHeight() / 20) * 6.3;
+    const int variantH = getHeight() / 30;
+    addVariantButton.setBounds(0, variantY, getWidth() / 10, variantH);
+    variantLayerSelector.setBounds(getWidth() / 10, variantY, getWidth() / 10, variantH);
+    variantPolicySelector.setBounds((getWidth() / 10) * 2, variantY, getWidth() / 8, variantH);
+    clearVariantsButton.setBounds((getWidth() / 10) * 2 + getWidth() / 8, variantY, getWidth() / 8, variantH);
+    variantsLabel.setBounds((getWidth() / 10) * 2 + getWidth() / 4, variantY, getWidth() / 5, variantH);
+    resampleButton.setBounds(getWidth() - getWidth() / 10, variantY, getWidth() / 10, variantH);
+    redoButton.setBounds(getWidth() / 20, (getHeight() / 20) * 5, getWidth() / 20, getHeight() / 20);
+    
+    performanceMeter.setBounds(column * 8, (getHeight() / 10) * 3.5, column * 4, row * 0.8);
     
     float sequencerStartY = (getHeight() / 10) * 6.9 + (getHeight() / 15);
     sequencer.setBounds(0, sequencerStartY, getWidth(), getHeight() - sequencerStartY);
@@ -189,6 +273,219 @@ void SampleChopperAudioProcessorEditor::resized()
 void SampleChopperAudioProcessorEditor::timerCallback()
 {
     waveformDisplay.repaint();
+    
+    //a newly loaded sample has been analysed
+    auto& sampleAnalyser = audioProcessor.getSampleAnalyser();
+    
+    if(sampleAnalyser.getVersion() != beatGridVersion)
+    {
+        beatGridVersion = sampleAnalyser.getVersion();
+        beatGrid = sampleAnalyser.getBeatGrid();
+        waveformDisplay.setBeatGrid(beatGrid);
+        
+        if(beatGrid.isValid())
+        {
+            sequencer.setBpm(beatGrid.bpm);
+        }
+    }
+    
+    if(offlineRenderer != nullptr && offlineRenderer->isThreadRunning())
+    {
+        bounceButton.setButtonText(juce::String(juce::roundToInt(offlineRenderer->getProgress() * 100.0f)) + "%");
+    }
+    
+    if(resampleRenderer != nullptr && resampleRenderer->isThreadRunning())
+    {
+        resampleButton.setButtonText(juce::String(juce::roundToInt(resampleRenderer->getProgress() * 100.0f)) + "%");
+    }
+    
+    //a sample the processor made itself, a recorded take
+    if(audioProcessor.getSampleVersion() != sampleVersion)
+    {
+        sampleVersion = audioProcessor.getSampleVersion();
+        
+        if(auto sample = audioProcessor.getListenerBank()->getSample())
+        {
+            waveformDisplay.loadSample(*sample);
+        }
+    }
+    
+    updateRecordButton();
+}
+
+void SampleChopperAudioProcessorEditor::updateRecordButton()
+{
+    const auto state = audioProcessor.getInputRecorder().getState();
+    
+    const juce::String text = state == InputRecorder::State::armed ? "Armed"
+                            : state == InputRecorder::State::recording ? "Stop" : "Record";
+    
+    if(recordButton.getButtonText() != text)
+    {
+        recordButton.setButtonText(text);
+        recordButton.setColour(juce::TextButton::buttonColourId, state == InputRecorder::State::idle ? getLookAndFeel().findColour(juce::TextButton::buttonColourId)
+                                                                                                      : juce::Colours::darkred);
+    }
+}
+
+void SampleChopperAudioProcessorEditor::startBounce()
+{
+    if(!audioProcessor.getListenerBank()->isURLLoaded())
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Bounce", "Load a sample first");
+        return;
+    }
+    
+    juce::FileChooser chooser("Bounce to...", juce::File(), "*.wav");
+    if(!chooser.browseForFileToSave(true))
+    {
+        return;
+    }
+    
+    OfflineRenderer::Options options;
+    options.outputFile = chooser.getResult().withFileExtension("wav");
+    options.sampleRate = audioProcessor.getSampleRate() > 0 ? audioProcessor.getSampleRate() : 44100.0;
+    options.renderStems = bounceStemsButton.getToggleState();
+    
+    offlineRenderer = std::make_unique<OfflineRenderer>(audioProcessor, options);
+    offlineRenderer->onFinished = [safeThis = juce::Component::SafePointer<SampleChopperAudioProcessorEditor>(this)](bool succeeded)
+    {
+        if(safeThis == nullptr) //editor closed while bouncing
+        {
+            return;
+        }
+        
+        safeThis->bounceButton.setButtonText("Bounce");
+        safeThis->bounceButton.setEnabled(true);
+        
+        if(!succeeded)
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Bounce failed", safeThis->offlineRenderer->getErrorMessage());
+        }
+    };
+    
+    bounceButton.setEnabled(false);
+    offlineRenderer->startThread(juce::Thread::Priority::normal);
+}
+
+void SampleChopperAudioProcessorEditor::startResample()
+{
+    if(!audioProcessor.getListenerBank()->isURLLoaded())
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Resample", "Load a sample first");
+        return;
+    }
+    
+    OfflineRenderer::Options options;
+    options.sampleRate = audioProcessor.getSampleRate() > 0 ? audioProcessor.getSampleRate() : 44100.0;
+    options.renderToSample = true;
+    options.tailSeconds = 0.0; //exactly the pattern, so it loops and slices on the bar
+    
+    resampleRenderer = std::make_unique<OfflineRenderer>(audioProcessor, options);
+    resampleRenderer->onFinished = [safeThis = juce::Component::SafePointer<SampleChopperAudioProcessorEditor>(this)](bool succeeded)
+    {
+        if(safeThis == nullptr) //editor closed while rendering, the result goes with it
+        {
+            return;
+        }
+        
+        safeThis->resampleButton.setButtonText("Resample");
+        safeThis->resampleButton.setEnabled(true);
+        
+        auto& renderer = *safeThis->resampleRenderer;
+        
+        if(!succeeded || renderer.getRenderedSample() == nullptr)
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Resample failed", renderer.getErrorMessage());
+            return;
+        }
+        
+        //the banks swap over without stopping the sequencer, the timer picks the new sample up for the waveform
+        safeThis->audioProcessor.setMainSample(renderer.getRenderedSample(), renderer.getRenderedBeatGrid());
+        juce::URL noFile; //nothing on disk to reload it from with the session
+        safeThis->audioProcessor.setFilePath(noFile);
+    };
+    
+    resampleButton.setEnabled(false);
+    resampleRenderer->startThread(juce::Thread::Priority::normal);
+}
+
+void SampleChopperAudioProcessorEditor::sliceToGrid()
+{
+    if(!audioProcessor.sliceToBeatGrid(sliceDivisionSelector.getSelectedId(), waveformDisplay.getWaveformStart()))
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Slice", "No beat grid yet, load a sample and wait for its tempo to show");
+    }
+}
+
+void SampleChopperAudioProcessorEditor::addVariant()
+{
+    if(bankSelected >= 6)
+    {
+        return;
+    }
+    
+    Bank* bank = bankList[bankSelected - 1];
+    
+    if(!bank->loopRegion.proper())
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Variants", "Drag out a loop region for the bank first");
+        return;
+    }
+    
+    //the table is rebuilt whole and swapped in, the audio thread only ever sees a finished one
+    std::vector<SliceVariants::Variant> variants;
+    
+    if(auto current = bank->getSliceVariants())
+    {
+        variants = current->getVariants();
+    }
+    
+    if(variants.size() >= SliceVariants::maxVariants)
+    {
+        return;
+    }
+    
+    variants.push_back({bank->loopRegion, variantLayerSelector.getSelectedId() - 1});
+    
+    const auto policy = variantPolicySelector.getSelectedId() == 2 ? SliceVariants::Policy::random : SliceVariants::Policy::roundRobin;
+    bank->setSliceVariants(new SliceVariants(std::move(variants), policy));
+    updateVariantControls();
+}
+
+void SampleChopperAudioProcessorEditor::setVariantPolicy()
+{
+    if(bankSelected >= 6)
+    {
+        return;
+    }
+    
+    Bank* bank = bankList[bankSelected - 1];
+    auto current = bank->getSliceVariants();
+    
+    if(current != nullptr)
+    {
+        const auto policy = variantPolicySelector.getSelectedId() == 2 ? SliceVariants::Policy::random : SliceVariants::Policy::roundRobin;
+        bank->setSliceVariants(new SliceVariants(current->getVariants(), policy));
+    }
+}
+
+void SampleChopperAudioProcessorEditor::updateVariantControls()
+{
+    const bool bankChosen = bankSelected < 6;
+    auto variants = bankChosen ? bankList[bankSelected - 1]->getSliceVariants() : nullptr;
+    
+    addVariantButton.setEnabled(bankChosen);
+    clearVariantsButton.setEnabled(variants != nullptr);
+    
+    if(variants != nullptr)
+    {
+        variantPolicySelector.setSelectedId(variants->getPolicy() == SliceVariants::Policy::random ? 2 : 1, juce::dontSendNotification);
+        variantsLabel.setText(juce::String(variants->getVariants().size()) + " variants", juce::dontSendNotification);
+    }else
+    {
+        variantsLabel.setText(bankChosen ? "Plays the loop region" : "", juce::dontSendNotification);
+    }
 }
 
 void SampleChopperAudioProcessorEditor::buttonClicked(juce::Button *button)
@@ -206,6 +503,7 @@ void SampleChopperAudioProcessorEditor::buttonClicked(juce::Button *button)
             
             audioProcessor.loadURLS(url);
             waveformDisplay.loadURL(url);
+            sampleVersion = audioProcessor.getSampleVersion(); //already showing it
             
             juce::File audioFile = url.getLocalFile();
             globalAudioFile = audioFile;
@@ -213,18 +511,67 @@ void SampleChopperAudioProcessorEditor::buttonClicked(juce::Button *button)
         }
     }
     
+    if(&bounceButton == button)
+    {
+        startBounce();
+    }
+    
+    if(&resampleButton == button)
+    {
+        startResample();
+    }
+    
+    if(&recordButton == button)
+    {
+        auto& inputRecorder = audioProcessor.getInputRecorder();
+        
+        if(inputRecorder.getState() == InputRecorder::State::idle)
+        {
+            inputRecorder.arm();
+        }else
+        {
+            inputRecorder.stop();
+        }
+        
+        updateRecordButton();
+    }
+    
+    if(&sliceButton == button)
+    {
+        sliceToGrid();
+    }
+    
+    if(&addVariantButton == button)
+    {
+        addVariant();
+    }
+    
+    if(&clearVariantsButton == button && bankSelected < 6)
+    {
+        bankList[bankSelected - 1]->setSliceVariants(nullptr);
+        updateVariantControls();
+    }
+    
+    if(&undoButton == button)
+    {
+        audioProcessor.undoManager.undo();
+    }
+    
+    if(&redoButton == button)
+    {
+        audioProcessor.undoManager.redo();
+    }
+    
     if(&showTransientsButton == button)
     {
-        if(showTransientsFlag == false)
+        if(showTransientsButton.getToggleState())
         {
             waveformDisplay.showTransients();
-            showTransientsFlag = true;
             DBG("Showing Transients");
         }
-        else if(showTransientsFlag == true)
+        else
             {
                 waveformDisplay.hideTransients();
-                showTransientsFlag = false;
                 DBG("Hiding Transients");
             }
         }
@@ -276,6 +623,11 @@ void SampleChopperAudioProcessorEditor::buttonClicked(juce::Button *button)
     
     DBG(bankSelected);
     
+    if(isSelectorButtonPressed)
+    {
+        updateVariantControls();
+    }
+    
     
     //Bank used to listen to the audio (has no GUI)
     Bank * listenerBank = audioProcessor.getListenerBank();
@@ -297,16 +649,6 @@ void SampleChopperAudioProcessorEditor::buttonClicked(juce::Button *button)
 
 void SampleChopperAudioProcessorEditor::sliderValueChanged(juce::Slider *slider)
 {
-    if(&globalPitchSlider == slider)
-    {
-        float speed = (globalPitchSlider.getValue() / 10) + 1;
-        
-        for(int i = 0; i < bankList.size(); i++)
-        {
-            bankList[i]->setSpeed(speed);
-        }
-    }
-    
     if(&transientWindowSizeSlider == slider)
     {
         waveformDisplay.setTransientWindowSize(transientWindowSizeSlider.getValue()); //this wont work as need to pass the recent file loaded into that bank
@@ -330,6 +672,7 @@ void SampleChopperAudioProcessorEditor::fileDroppedOnWaveform(const juce::URL &f
     juce::URL url(file);
     waveformDisplay.loadURL(url);
     audioProcessor.loadURLS(url);
+    sampleVersion = audioProcessor.getSampleVersion();
 }
 
 void SampleChopperAudioProcessorEditor::paintOverChildren(juce::Graphics& g)
@@ -372,11 +715,25 @@ void SampleChopperAudioProcessorEditor::mouseDown(const juce::MouseEvent& event)
 {
     if(&waveformDisplay == event.eventComponent)
     {
+        //only a region drag on banks A to E is an edit, the region edits from every mouseDrag of it coalesce into this one undo step
+        if(event.getMouseDownY() < waveformDisplay.getScrollerStartY() && bankSelected < 6)
+        {
+            audioProcessor.undoManager.beginNewTransaction("Loop region");
+        }
+        
         mouseDrag(event);
     }
     
 }
 
+void SampleChopperAudioProcessorEditor::mouseUp(const juce::MouseEvent& event)
+{
+    if(&waveformDisplay == event.eventComponent)
+    {
+        audioProcessor.undoManager.beginNewTransaction(); //so nothing after the drag joins its undo step
+    }
+}
+
 void SampleChopperAudioProcessorEditor::mouseDrag(const juce::MouseEvent& event)
 {
     
@@ -403,7 +760,9 @@ void SampleChopperAudioProcessorEditor::mouseDrag(const juce::MouseEvent& event)
             
             if(bankSelected < 6)
             {
-                bankList[bankSelected - 1]->setLoopRegion(trueStart, trueEnd); //0-1 percentage of file
+                trueStart = snapToGrid(trueStart, fileLength);
+                trueEnd = snapToGrid(trueEnd, fileLength);
+                audioProcessor.setBankLoopRegion(bankSelected - 1, trueStart, trueEnd); //0-1 percentage of file, a hand drawn region plays at its own speed
             }
             else if(bankSelected == 6)
             {
@@ -415,3 +774,50 @@ void SampleChopperAudioProcessorEditor::mouseDrag(const juce::MouseEvent& event)
     
 }
 
+double SampleChopperAudioProcessorEditor::snapToGrid(double normalisedPosition, double fileLength) const
+{
+    if(!beatGrid.isValid() || fileLength <= 0)
+    {
+        return normalisedPosition;
+    }
+    
+    const double seconds = normalisedPosition * fileLength;
+    
+    switch(snapSelector.getSelectedId())
+    {
+        case snapBar:
+            return beatGrid.snapToBar(seconds) / fileLength;
+        case snapBeat:
+            return beatGrid.snapToBeat(seconds) / fileLength;
+        default:
+            return normalisedPosition;
+    }
+}
+
+void SampleChopperAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    if(source != &audioProcessor.undoManager)
+    {
+        return;
+    }
+    
+    undoButton.setEnabled(audioProcessor.undoManager.canUndo());
+    redoButton.setEnabled(audioProcessor.undoManager.canRedo());
+    
+    sequencer.refreshSteps(); //an undone step edit only changed the engine
+}
+
+bool SampleChopperAudioProcessorEditor::keyPressed(const juce::KeyPress& key)
+{
+    if(key == juce::KeyPress('z', juce::ModifierKeys::commandModifier, 0))
+    {
+        return audioProcessor.undoManager.undo();
+    }
+    
+    if(key == juce::KeyPress('z', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0))
+    {
+        return audioProcessor.undoManager.redo();
+    }
+    
+    return false;
+}
@@ -13,11 +13,13 @@
 #include "BankGUI.h"
 #include "WaveformDisplay.h"
 #include "Sequencer.h"
+#include "OfflineRenderer.h"
+#include "PerformanceMeter.h"
 
 //==============================================================================
 /**
 */
-class SampleChopperAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Button::Listener, public juce::Slider::Listener, public juce::Timer
+class SampleChopperAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Button::Listener, public juce::Slider::Listener, public juce::Timer, public juce::ChangeListener
 {
 public:
     SampleChopperAudioProcessorEditor (SampleChopperAudioProcessor&);
@@ -29,6 +31,8 @@ public:
     void buttonClicked(juce::Button *button) override; //button virtual
     void sliderValueChanged(juce::Slider * slider) override; //slider virtual
     void timerCallback() override;
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override; //the undo manager
+    bool keyPressed(const juce::KeyPress& key) override; //cmd/ctrl z to undo, with shift to redo
     
     void fileDroppedOnWaveform(const juce::URL& fileURL); //this is the function
     void setSelectorCallback(const int bankSelected);
@@ -36,6 +40,7 @@ public:
     void paintOverChildren(juce::Graphics& g) override;
     void mouseDown(const juce::MouseEvent& event) override;
     void mouseDrag(const juce::MouseEvent& event) override;
+    void mouseUp(const juce::MouseEvent& event) override;
     
     void setPlayheadPos(double pos, int bank);
     
@@ -47,11 +52,11 @@ private:
     
     //Create bankGUIs and pass them the bank they are assigned to
     //As getBank returns a pointer to a bank, we must dereference to get what is insde the pointer
-    BankGUI bankGUI1{*audioProcessor.getBank(1)};
-    BankGUI bankGUI2{*audioProcessor.getBank(2)};
-    BankGUI bankGUI3{*audioProcessor.getBank(3)};
-    BankGUI bankGUI4{*audioProcessor.getBank(4)};
-    BankGUI bankGUI5{*audioProcessor.getBank(5)};
+    BankGUI bankGUI1{*audioProcessor.getBank(1), audioProcessor.apvts, 1};
+    BankGUI bankGUI2{*audioProcessor.getBank(2), audioProcessor.apvts, 2};
+    BankGUI bankGUI3{*audioProcessor.getBank(3), audioProcessor.apvts, 3};
+    BankGUI bankGUI4{*audioProcessor.getBank(4), audioProcessor.apvts, 4};
+    BankGUI bankGUI5{*audioProcessor.getBank(5), audioProcessor.apvts, 5};
     
     std::vector<juce::ADSR::Parameters*> paramsList;
     
@@ -63,18 +68,57 @@ private:
     juce::TextButton listenerBankPlay{"Play"};
     juce::TextButton listenerBankStop{"Stop"};
     juce::TextButton sliceButton{"Slice"};
+    juce::ComboBox sliceDivisionSelector; //item ID is the number of slices per beat
+    void sliceToGrid();
+    
+    //slice variants for the selected bank, the loop region is added to the chosen velocity layer
+    juce::TextButton addVariantButton{"+ Variant"};
+    juce::ComboBox variantLayerSelector; //item ID is the layer + 1
+    juce::ComboBox variantPolicySelector;
+    juce::TextButton clearVariantsButton{"Clear Variants"};
+    juce::Label variantsLabel;
+    void addVariant();
+    void setVariantPolicy();
+    void updateVariantControls(); //after an edit or a different bank is selected
+    
+    juce::TextButton undoButton{"Undo"};
+    juce::TextButton redoButton{"Redo"};
+    
+    //bounce the pattern to a WAV, optionally with a stem per bank
+    juce::TextButton bounceButton{"Bounce"};
+    juce::ToggleButton bounceStemsButton{"Stems"};
+    std::unique_ptr<OfflineRenderer> offlineRenderer;
+    void startBounce();
+    
+    //renders the pattern the same way and loads the result as the new sample, to chop again
+    juce::TextButton resampleButton{"Resample"};
+    std::unique_ptr<OfflineRenderer> resampleRenderer;
+    void startResample();
+    
+    //arms recording from the host's input, then stops the take, the timer shows which
+    juce::TextButton recordButton{"Record"};
+    void updateRecordButton();
+    int sampleVersion = 0; //last processor sample version shown in the waveform
     
     //juce::Slider globalPitchSlider;
     juce::TextButton incrementSemiButton{"+ 1 Semitones"};
     juce::TextButton decrementSemiButton{"- 1 Semitones"};
     
     juce::Slider globalPitchSlider;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> globalPitchAttachment;
     
     juce::TextButton showTransientsButton{"Show Transients"};
-    bool showTransientsFlag = true;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> showTransientsAttachment;
     juce::Slider transientWindowSizeSlider;
     juce::Slider transientSensitivitySlider;
     
+    //loop regions can snap to the detected beat grid
+    juce::ComboBox snapSelector;
+    enum SnapMode {snapOff = 1, snapBar, snapBeat}; //ComboBox item IDs
+    BeatGrid beatGrid;
+    int beatGridVersion = 0; //last SampleAnalyser version picked up by the timer
+    double snapToGrid(double normalisedPosition, double fileLength) const;
+    
     //Pointer Vectors - need to be set to nullptr in destructor
     std::vector<Bank*>bankList = {audioProcessor.getBank(1), audioProcessor.getBank(2), audioProcessor.getBank(3), audioProcessor.getBank(4), audioProcessor.getBank(5), audioProcessor.getBank(6)};
     
@@ -97,7 +141,9 @@ private:
     //My colours for the UI
     std::vector<juce::Colour> myColours = {juce::Colours::navy, juce::Colours::darkred, juce::Colours::orange, juce::Colours::black, juce::Colours::purple};
     
-    Sequencer sequencer;
+    Sequencer sequencer{audioProcessor.getSequencerEngine(), audioProcessor.undoManager};
+    
+    PerformanceMeter performanceMeter{audioProcessor.getPerformanceMonitor()};
     
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleChopperAudioProcessorEditor)
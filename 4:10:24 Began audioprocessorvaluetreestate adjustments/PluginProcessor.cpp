@@ -8,28 +8,135 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "UndoableEdits.h"
 
 //==============================================================================
 SampleChopperAudioProcessor::SampleChopperAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
      : AudioProcessor (BusesProperties()
                      #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
+                       //a synth too, the input is what the Record button records
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                        #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                       //one optional stereo output per bank, off until the host enables it
+                       .withOutput ("Bank A", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Bank B", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Bank C", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Bank D", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Bank E", juce::AudioChannelSet::stereo(), false)
                      #endif
                        ),
 apvts(*this, nullptr, "PARAMETERS", createParameterLayout()),
+gestureRecorder(*this, undoManager),
 settingsTree("Settings")
 #endif
 {
     formatManager.registerBasicFormats(); //format manager for waveform
     settingsTree.setProperty("filePath", "", nullptr);
+    
+    masterGainParameter = apvts.getRawParameterValue("gainVal");
+    globalSpeedParameter = apvts.getRawParameterValue("globalSpeed");
+    
+    masterParameters.filterOn = apvts.getRawParameterValue("masterFilterOn");
+    masterParameters.filterMode = apvts.getRawParameterValue("masterFilterMode");
+    masterParameters.cutoff = apvts.getRawParameterValue("masterCutoff");
+    masterParameters.resonance = apvts.getRawParameterValue("masterResonance");
+    masterParameters.compressorOn = apvts.getRawParameterValue("masterCompOn");
+    masterParameters.threshold = apvts.getRawParameterValue("masterThreshold");
+    masterParameters.ratio = apvts.getRawParameterValue("masterRatio");
+    masterParameters.attack = apvts.getRawParameterValue("masterAttack");
+    masterParameters.release = apvts.getRawParameterValue("masterRelease");
+    masterParameters.saturatorOn = apvts.getRawParameterValue("masterSatOn");
+    masterParameters.saturation = apvts.getRawParameterValue("masterSaturation");
+    masterParameters.oversampling = apvts.getRawParameterValue("masterOversampling");
+    masterParameters.oversamplingFilter = apvts.getRawParameterValue("masterOversamplingFilter");
+    masterParameters.limiterOn = apvts.getRawParameterValue("masterLimiterOn");
+    masterParameters.ceiling = apvts.getRawParameterValue("masterCeiling");
+    
+    delayTimeParameter = apvts.getRawParameterValue("delayTime");
+    delayFeedbackParameter = apvts.getRawParameterValue("delayFeedback");
+    delayDampingParameter = apvts.getRawParameterValue("delayDamping");
+    delayReturnParameter = apvts.getRawParameterValue("delayReturn");
+    reverbDecayParameter = apvts.getRawParameterValue("reverbDecay");
+    reverbReturnParameter = apvts.getRawParameterValue("reverbReturn");
+    apvts.addParameterListener("reverbDecay", this);
+    sampleAnalyser.addChangeListener(this);
+    
+    inputRecorder.onRecordingFinished = [this](SampleBuffer::Ptr take)
+    {
+        setMainSample(take);
+        settingsTree.setProperty("filePath", "", nullptr); //the take isn't a file, don't reload the last one with the session
+        sliceWhenAnalysed = true;
+    };
+    modControlRateParameter = apvts.getRawParameterValue("modControlRate");
+    
+    for(int i = 1; i <= numberOfSampleBanks; i++)
+    {
+        BankParameterPointers pointers;
+        pointers.volume = apvts.getRawParameterValue(getBankParameterID(i, "Volume"));
+        pointers.attack = apvts.getRawParameterValue(getBankParameterID(i, "Attack"));
+        pointers.decay = apvts.getRawParameterValue(getBankParameterID(i, "Decay"));
+        pointers.sustain = apvts.getRawParameterValue(getBankParameterID(i, "Sustain"));
+        pointers.release = apvts.getRawParameterValue(getBankParameterID(i, "Release"));
+        pointers.pan = apvts.getRawParameterValue(getBankParameterID(i, "Pan"));
+        pointers.pitch = apvts.getRawParameterValue(getBankParameterID(i, "Pitch"));
+        pointers.playMode = apvts.getRawParameterValue(getBankParameterID(i, "PlayMode"));
+        pointers.startOffset = apvts.getRawParameterValue(getBankParameterID(i, "StartOffset"));
+        pointers.chokeGroup = apvts.getRawParameterValue(getBankParameterID(i, "ChokeGroup"));
+        pointers.filterOn = apvts.getRawParameterValue(getBankParameterID(i, "FilterOn"));
+        pointers.filterType = apvts.getRawParameterValue(getBankParameterID(i, "FilterType"));
+        pointers.cutoff = apvts.getRawParameterValue(getBankParameterID(i, "Cutoff"));
+        pointers.resonance = apvts.getRawParameterValue(getBankParameterID(i, "Resonance"));
+        pointers.filterEnvelope = apvts.getRawParameterValue(getBankParameterID(i, "FilterEnv"));
+        pointers.driveOn = apvts.getRawParameterValue(getBankParameterID(i, "DriveOn"));
+        pointers.drive = apvts.getRawParameterValue(getBankParameterID(i, "Drive"));
+        pointers.crushOn = apvts.getRawParameterValue(getBankParameterID(i, "CrushOn"));
+        pointers.bits = apvts.getRawParameterValue(getBankParameterID(i, "Bits"));
+        pointers.downsample = apvts.getRawParameterValue(getBankParameterID(i, "Downsample"));
+        pointers.shaperOn = apvts.getRawParameterValue(getBankParameterID(i, "ShaperOn"));
+        pointers.shaperAttack = apvts.getRawParameterValue(getBankParameterID(i, "ShaperAttack"));
+        pointers.shaperSustain = apvts.getRawParameterValue(getBankParameterID(i, "ShaperSustain"));
+        
+        for(int slot = 0; slot < ModulationMatrix::numberOfSlots; slot++)
+        {
+            const juce::String slotName = "Mod" + juce::String(slot + 1);
+            pointers.modSource[static_cast<size_t>(slot)] = apvts.getRawParameterValue(getBankParameterID(i, slotName + "Source"));
+            pointers.modDestination[static_cast<size_t>(slot)] = apvts.getRawParameterValue(getBankParameterID(i, slotName + "Dest"));
+            pointers.modAmount[static_cast<size_t>(slot)] = apvts.getRawParameterValue(getBankParameterID(i, slotName + "Amount"));
+        }
+        
+        pointers.lfoRate = apvts.getRawParameterValue(getBankParameterID(i, "LfoRate"));
+        pointers.lfoShape = apvts.getRawParameterValue(getBankParameterID(i, "LfoShape"));
+        pointers.modAttack = apvts.getRawParameterValue(getBankParameterID(i, "ModAttack"));
+        pointers.modDecay = apvts.getRawParameterValue(getBankParameterID(i, "ModDecay"));
+        pointers.grainDensity = apvts.getRawParameterValue(getBankParameterID(i, "GrainDensity"));
+        pointers.grainSize = apvts.getRawParameterValue(getBankParameterID(i, "GrainSize"));
+        pointers.grainSpray = apvts.getRawParameterValue(getBankParameterID(i, "GrainSpray"));
+        pointers.grainPitch = apvts.getRawParameterValue(getBankParameterID(i, "GrainPitch"));
+        pointers.grainWindow = apvts.getRawParameterValue(getBankParameterID(i, "GrainWindow"));
+        pointers.delaySend = apvts.getRawParameterValue(getBankParameterID(i, "DelaySend"));
+        pointers.reverbSend = apvts.getRawParameterValue(getBankParameterID(i, "ReverbSend"));
+        
+        bankParameters.push_back(pointers);
+    }
+    
+    for(auto& bankIndex : noteToBank)
+    {
+        bankIndex = -1;
+    }
+    
+    for(int i = 0; i < numberOfSampleBanks; i++)
+    {
+        noteToBank[36 + i] = i;
+    }
 }
 
 SampleChopperAudioProcessor::~SampleChopperAudioProcessor()
 {
+    apvts.removeParameterListener("reverbDecay", this);
+    sampleAnalyser.removeChangeListener(this);
+    cancelPendingUpdate();
+    
     for(int i = 0; i < bankList.size(); i++)
     {
         bankList[i] = nullptr;
@@ -104,21 +211,41 @@ void SampleChopperAudioProcessor::prepareToPlay (double sampleRate, int samplesP
     
     for(int i = 0; i < bankList.size(); i++)
     {
-        mixerSource.addInputSource(bankList[i], false);
+        bankList[i]->prepareToPlay(samplesPerBlock, sampleRate);
     }
     
-    mixerSource.prepareToPlay(samplesPerBlock, sampleRate); //prepare to play
+    summingBus.prepare(juce::jmax(2, getMainBusNumOutputChannels()), samplesPerBlock);
+    
+    for(int i = 0; i < numberOfSampleBanks; i++)
+    {
+        auto* bus = getBus(false, getBankBusIndex(i));
+        bankBusEnabled[i] = bus != nullptr && bus->isEnabled();
+    }
+    sequencerEngine.prepareToPlay(sampleRate);
+    inputRecorder.prepare(sampleRate);
+    performanceMonitor.prepare(sampleRate);
+    masterEffects.prepare(sampleRate, samplesPerBlock, juce::jmax(1, getMainBusNumOutputChannels()));
+    sendEffects.setReverbDecay(reverbDecayParameter->load()); //picks up a decay changed while we weren't playing
+    sendEffects.prepare(sampleRate, samplesPerBlock, juce::jmax(1, getMainBusNumOutputChannels()));
+    blockEvents.reserve(maxEventsPerBlock);
+    
+    masterGainSmoothed.reset(sampleRate, 0.05);
+    masterGainSmoothed.setCurrentAndTargetValue(masterGainParameter->load());
+    
+    updateBankParameters();
+    updateMasterParameters();
+    setLatencySamples(masterLatency); //not the audio thread, so the host can be told now rather than after the first block
+    masterEffects.reset();
 }
 
 void SampleChopperAudioProcessor::releaseResources()
 {
-    mixerSource.removeAllInputs(); //releasing resources
-    mixerSource.releaseResources();
-    
     for(int i = 0; i < bankList.size(); i++)
     {
         bankList[i]->releaseResources();
     }
+    
+    summingBus.release();
 
 }
 
@@ -141,8 +268,22 @@ bool SampleChopperAudioProcessor::isBusesLayoutSupported (const BusesLayout& lay
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+   #else
+    //the input is only recorded, so it can be off, mono or stereo whatever the output is
+    if (! layouts.getMainInputChannelSet().isDisabled()
+     && layouts.getMainInputChannelSet() != juce::AudioChannelSet::mono()
+     && layouts.getMainInputChannelSet() != juce::AudioChannelSet::stereo())
+        return false;
    #endif
 
+    //bank outputs are either off or stereo
+    for (int i = 1; i < layouts.outputBuses.size(); ++i)
+    {
+        if (! layouts.outputBuses[i].isDisabled()
+         && layouts.outputBuses[i] != juce::AudioChannelSet::stereo())
+            return false;
+    }
+
     return true;
   #endif
 }
@@ -152,19 +293,11 @@ void SampleChopperAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
 {
 
     juce::ScopedNoDenormals noDenormals;
+    performanceMonitor.beginBlock(buffer.getNumSamples());
+    
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     
-    int numberOfLoadedFiles = 0;
-    
-    for(int i = 0; i < bankList.size(); i++)
-    {
-       if(bankList[i]->isURLLoaded())
-       {
-           numberOfLoadedFiles++;
-       }
-    }
-
     const int numSamples = buffer.getNumSamples();
    
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
@@ -172,14 +305,343 @@ void SampleChopperAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
         buffer.clear (i, 0, buffer.getNumSamples());
     }
     
-    juce::AudioBuffer<float> tempBuffer(totalNumInputChannels, numSamples);
+    //before anything is rendered on top of the input
+    if(totalNumInputChannels > 0)
+    {
+        inputRecorder.process(getBusBuffer(buffer, true, 0), numSamples);
+    }
+    
+    //the main output shares its channels with the input, it's only what the banks render from here on
+    mainOutput = getBusBuffer(buffer, false, 0);
+    mainOutput.clear();
+    
+    //gather this block's notes, the sequencer runs even with nothing loaded so it stays in time with the host
+    blockEvents.clear();
+    addMidiEvents(midiMessages);
+    sequencerEngine.processBlock(getPlayHead(), numSamples, blockEvents);
+    
+    //after the sequencer has read this block's tempo, grid sync, tempo synced delays and the LFOs all follow it
+    updateBankParameters();
+    
+    //insertion sort keeps MIDI before sequencer notes on the same sample and doesn't allocate
+    for(int i = 1; i < blockEvents.size(); i++)
+    {
+        for(int j = i; j > 0 && blockEvents[j].samplePosition < blockEvents[j - 1].samplePosition; j--)
+        {
+            std::swap(blockEvents[j], blockEvents[j - 1]);
+        }
+    }
+    
+    performanceMonitor.endStage(PerformanceMonitor::sequencer);
+
+    //render up to each event, handle it, then carry on so notes start on their exact sample
+    int renderPosition = 0;
+    bool anythingRendered = false;
+    summingBus.beginBlock(numSamples);
+    
+    //banks with an enabled aux output render straight into the host's channels for that bus
+    for(int i = 0; i < numberOfSampleBanks; i++)
+    {
+        if(bankBusEnabled[i])
+        {
+            bankBusOutputs[i] = getBusBuffer(buffer, false, getBankBusIndex(i));
+            
+            if(bankBusOutputs[i].getNumChannels() > 0)
+            {
+                summingBus.setBusOutput(i, &bankBusOutputs[i]);
+            }
+        }
+    }
+    
+    for(const auto& event : blockEvents)
+    {
+        const int eventPosition = juce::jlimit(renderPosition, numSamples, event.samplePosition);
+        
+        anythingRendered |= renderBanks(mainOutput, renderPosition, eventPosition - renderPosition);
+        renderPosition = eventPosition;
+        
+        handleBankEvent(event);
+    }
+    
+    anythingRendered |= renderBanks(mainOutput, renderPosition, numSamples - renderPosition);
+    summingBus.endBlock(mainOutput);
+    anythingRendered |= sendEffects.process(summingBus, mainOutput, numSamples); //returns go in before the master gain
+    
+    performanceMonitor.endStage(PerformanceMonitor::voices);
+    
+    masterGainSmoothed.setTargetValue(masterGainParameter->load());
+    
+    if(anythingRendered)
+    {
+        masterGainSmoothed.applyGain(mainOutput, numSamples); //aux outputs are left to the host's own faders
+    }else
+    {
+        masterGainSmoothed.skip(numSamples); //the buffer is already silent
+    }
+    
+    //runs even on silent blocks so the filter and compressor tails ring out
+    updateMasterParameters();
+    
+    if(masterEffects.isEnabled())
+    {
+        masterEffects.process(mainOutput, numSamples);
+    }
+    
+    performanceMonitor.endStage(PerformanceMonitor::mix);
+    performanceMonitor.endBlock();
+    
+}
+
+void SampleChopperAudioProcessor::chokeGroup(int bankIndex)
+{
+    const int group = bankChokeGroups[static_cast<size_t>(bankIndex)];
+    
+    if(group == 0)
+    {
+        return;
+    }
+    
+    auto others = chokeGroupMasks[static_cast<size_t>(group)] & ~(1u << bankIndex);
+    
+    while(others != 0)
+    {
+        const int other = juce::findHighestSetBit(others);
+        others &= ~(1u << other);
+        bankList[other]->choke();
+    }
+}
+
+bool SampleChopperAudioProcessor::renderBanks(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    bool rendered = false;
+    
+    if(numSamples <= 0)
+    {
+        return rendered;
+    }
+    
+    //each bank is checked on its own, stopped or released banks and banks without a file cost nothing
+    for(int i = 0; i < bankList.size(); i++)
+    {
+        if(bankList[i]->isURLLoaded() && bankList[i]->isActive())
+        {
+            bankList[i]->renderNextBlock(summingBus.getBankOutput(i, buffer), startSample, numSamples);
+            rendered = true;
+        }
+    }
+    
+    return rendered;
+}
 
-    if(numberOfLoadedFiles == bankList.size())
+void SampleChopperAudioProcessor::addMidiEvents(const juce::MidiBuffer& midiMessages)
+{
+    for(const auto metadata : midiMessages)
+    {
+        if(blockEvents.size() == blockEvents.capacity())
         {
-                        juce::AudioSourceChannelInfo channelInfo = (juce::AudioSourceChannelInfo(buffer)); //allows to treat function as getNextAudioBlock
-            mixerSource.getNextAudioBlock(channelInfo);
+            break; //never grows on the audio thread
         }
+        
+        const auto message = metadata.getMessage();
+        
+        BankEvent event;
+        event.samplePosition = metadata.samplePosition;
+        
+        if(message.isNoteOn() || message.isNoteOff())
+        {
+            event.bankIndex = noteToBank[message.getNoteNumber()];
+            
+            if(event.bankIndex < 0)
+            {
+                continue;
+            }
+            
+            event.type = message.isNoteOn() ? BankEvent::Type::noteOn : BankEvent::Type::noteOff;
+            event.velocity = message.getFloatVelocity(); //velocity scales the bank's gain
+        }
+        else if(message.isAllNotesOff() || message.isAllSoundOff())
+        {
+            event.type = BankEvent::Type::allNotesOff;
+        }
+        else
+        {
+            continue;
+        }
+        
+        blockEvents.push_back(event);
+    }
+}
+
+void SampleChopperAudioProcessor::handleBankEvent(const BankEvent& event)
+{
+    switch(event.type)
+    {
+        case BankEvent::Type::noteOn:
+            if(event.velocity > 0.0f) //a zero velocity note on is a note off
+            {
+                chokeGroup(event.bankIndex);
+            }
+            
+            bankList[event.bankIndex]->noteOn(event.velocity, event.locks);
+            break;
+            
+        case BankEvent::Type::noteOff:
+            bankList[event.bankIndex]->noteOff(); //starts the ADSR release
+            break;
+            
+        case BankEvent::Type::allNotesOff:
+            for(int i = 0; i < numberOfSampleBanks; i++)
+            {
+                bankList[i]->noteOff();
+            }
+            break;
+    }
+}
+
+void SampleChopperAudioProcessor::updateBankParameters()
+{
+    float globalSpeed = (globalSpeedParameter->load() / 10) + 1; //same mapping the global pitch slider used
+    const double bpm = sequencerEngine.getCurrentBpm();
     
+    chokeGroupMasks.fill(0);
+    
+    const int controlRateIndex = juce::jlimit(0, static_cast<int>(modulationControlIntervals.size()) - 1, juce::roundToInt(modControlRateParameter->load()));
+    
+    for(int i = 0; i < bankParameters.size(); i++)
+    {
+        const BankParameterPointers& pointers = bankParameters[i];
+        Bank* bank = bankList[i];
+        
+        bank->setGain(pointers.volume->load());
+        bank->setPanning(pointers.pan->load());
+        
+        float pitchRatio = std::exp2(pointers.pitch->load() / 12.0f); //semitones to ratio
+        
+        //grid slices stretch to the tempo, the ratio per bpm was worked out when the slice was cut
+        const double speedPerBpm = bankTempoSync[static_cast<size_t>(i)].load();
+        const float tempoRatio = speedPerBpm > 0.0 ? static_cast<float>(speedPerBpm * bpm) : 1.0f;
+        
+        bank->setSpeed(globalSpeed * pitchRatio * tempoRatio);
+        bank->setPlayMode(static_cast<Bank::PlayMode>(juce::roundToInt(pointers.playMode->load())));
+        bank->setStartOffset(pointers.startOffset->load());
+        
+        const int group = juce::jlimit(0, numberOfChokeGroups, juce::roundToInt(pointers.chokeGroup->load()));
+        bankChokeGroups[static_cast<size_t>(i)] = group;
+        chokeGroupMasks[static_cast<size_t>(group)] |= 1u << i;
+        
+        juce::ADSR::Parameters adsrParameters;
+        adsrParameters.attack = pointers.attack->load();
+        adsrParameters.decay = pointers.decay->load();
+        adsrParameters.sustain = pointers.sustain->load();
+        adsrParameters.release = pointers.release->load();
+        bank->setAdsrParameters(adsrParameters);
+        
+        BankEffects::Parameters effectParameters;
+        effectParameters.filterEnabled = pointers.filterOn->load() > 0.5f;
+        effectParameters.filterType = static_cast<BankEffects::FilterType>(juce::roundToInt(pointers.filterType->load()));
+        effectParameters.cutoff = pointers.cutoff->load();
+        effectParameters.resonance = pointers.resonance->load();
+        effectParameters.envelopeAmount = pointers.filterEnvelope->load();
+        effectParameters.driveEnabled = pointers.driveOn->load() > 0.5f;
+        effectParameters.drive = pointers.drive->load();
+        effectParameters.crushEnabled = pointers.crushOn->load() > 0.5f;
+        effectParameters.bitDepth = pointers.bits->load();
+        effectParameters.downsample = juce::roundToInt(pointers.downsample->load());
+        effectParameters.shaperEnabled = pointers.shaperOn->load() > 0.5f;
+        effectParameters.shaperAttack = pointers.shaperAttack->load();
+        effectParameters.shaperSustain = pointers.shaperSustain->load();
+        bank->setEffectParameters(effectParameters);
+        
+        ModulationMatrix::Parameters modulationParameters;
+        
+        for(int slot = 0; slot < ModulationMatrix::numberOfSlots; slot++)
+        {
+            auto& modulationSlot = modulationParameters.slots[static_cast<size_t>(slot)];
+            modulationSlot.source = static_cast<ModulationMatrix::Source>(juce::roundToInt(pointers.modSource[static_cast<size_t>(slot)]->load()));
+            modulationSlot.destination = static_cast<ModulationMatrix::Destination>(juce::roundToInt(pointers.modDestination[static_cast<size_t>(slot)]->load()));
+            modulationSlot.amount = pointers.modAmount[static_cast<size_t>(slot)]->load();
+        }
+        
+        modulationParameters.lfoBeats = lfoRateBeats[static_cast<size_t>(juce::jlimit(0, static_cast<int>(lfoRateBeats.size()) - 1, juce::roundToInt(pointers.lfoRate->load())))];
+        modulationParameters.lfoShape = static_cast<ModulationMatrix::LfoShape>(juce::roundToInt(pointers.lfoShape->load()));
+        modulationParameters.envelopeAttack = pointers.modAttack->load();
+        modulationParameters.envelopeDecay = pointers.modDecay->load();
+        modulationParameters.controlInterval = modulationControlIntervals[static_cast<size_t>(controlRateIndex)];
+        modulationParameters.bpm = bpm;
+        bank->setModulationParameters(modulationParameters);
+        
+        GranularEngine::Parameters granularParameters;
+        granularParameters.density = pointers.grainDensity->load();
+        granularParameters.size = pointers.grainSize->load();
+        granularParameters.spray = pointers.grainSpray->load();
+        granularParameters.pitch = pointers.grainPitch->load();
+        granularParameters.window = static_cast<GranularEngine::Window>(juce::roundToInt(pointers.grainWindow->load()));
+        bank->setGranularParameters(granularParameters);
+        
+        summingBus.setSendLevel(i, SendEffects::delaySend, pointers.delaySend->load());
+        summingBus.setSendLevel(i, SendEffects::reverbSend, pointers.reverbSend->load());
+    }
+    
+    SendEffects::Parameters sendParameters;
+    sendParameters.delayBeats = delayTimeBeats[static_cast<size_t>(juce::jlimit(0, static_cast<int>(delayTimeBeats.size()) - 1, juce::roundToInt(delayTimeParameter->load())))];
+    sendParameters.feedback = delayFeedbackParameter->load();
+    sendParameters.damping = delayDampingParameter->load();
+    sendParameters.delayReturn = delayReturnParameter->load();
+    sendParameters.reverbReturn = reverbReturnParameter->load();
+    sendEffects.setParameters(sendParameters, sequencerEngine.getCurrentBpm());
+    
+    listenerBank.setSpeed(globalSpeed);
+}
+
+void SampleChopperAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    juce::ignoreUnused(parameterID, newValue);
+    reverbDecayChanged = true;
+    triggerAsyncUpdate(); //can be the audio thread when the decay is automated
+}
+
+void SampleChopperAudioProcessor::handleAsyncUpdate()
+{
+    if(reverbDecayChanged.exchange(false))
+    {
+        sendEffects.setReverbDecay(reverbDecayParameter->load());
+    }
+    
+    const int latency = masterLatency;
+    
+    if(latency != getLatencySamples())
+    {
+        setLatencySamples(latency);
+    }
+}
+
+void SampleChopperAudioProcessor::updateMasterParameters()
+{
+    MasterEffects::Parameters parameters;
+    parameters.filterEnabled = masterParameters.filterOn->load() > 0.5f;
+    parameters.filterMode = static_cast<MasterEffects::FilterMode>(juce::roundToInt(masterParameters.filterMode->load()));
+    parameters.cutoff = masterParameters.cutoff->load();
+    parameters.resonance = masterParameters.resonance->load();
+    parameters.compressorEnabled = masterParameters.compressorOn->load() > 0.5f;
+    parameters.threshold = masterParameters.threshold->load();
+    parameters.ratio = masterParameters.ratio->load();
+    parameters.attack = masterParameters.attack->load();
+    parameters.release = masterParameters.release->load();
+    parameters.saturatorEnabled = masterParameters.saturatorOn->load() > 0.5f;
+    parameters.saturation = masterParameters.saturation->load();
+    parameters.oversamplingStages = juce::roundToInt(masterParameters.oversampling->load()); //choice index 0 - 3 is off, 2x, 4x, 8x
+    parameters.oversamplingFilter = static_cast<MasterEffects::OversamplingFilter>(juce::roundToInt(masterParameters.oversamplingFilter->load()));
+    parameters.limiterEnabled = masterParameters.limiterOn->load() > 0.5f;
+    parameters.ceiling = masterParameters.ceiling->load();
+    masterEffects.setParameters(parameters);
+    
+    //only changes when the saturator or its oversampling is switched
+    const int latency = masterEffects.getLatencySamples();
+    
+    if(masterLatency.exchange(latency) != latency)
+    {
+        triggerAsyncUpdate();
+    }
 }
 
 
@@ -198,27 +660,98 @@ juce::AudioProcessorEditor* SampleChopperAudioProcessor::createEditor()
 //==============================================================================
 void SampleChopperAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    //parameters and settings are stored together so the loaded file comes back with the automation
+    auto state = apvts.copyState();
+    state.appendChild(settingsTree.createCopy(), nullptr);
+    
+    std::unique_ptr<juce::XmlElement> xml(state.createXml());
+    copyXmlToBinary(*xml, destData);
 }
 
 void SampleChopperAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    std::unique_ptr<juce::XmlElement> xml(getXmlFromBinary(data, sizeInBytes));
+    
+    if(xml == nullptr || !xml->hasTagName(apvts.state.getType()))
+    {
+        return;
+    }
+    
+    auto state = juce::ValueTree::fromXml(*xml);
+    auto settings = state.getChildWithName(settingsTree.getType());
+    
+    if(settings.isValid())
+    {
+        settingsTree.copyPropertiesFrom(settings, nullptr);
+        state.removeChild(settings, nullptr);
+    }
+    
+    apvts.replaceState(state);
 }
 
 void SampleChopperAudioProcessor::loadURLS(juce::URL &url)
+{
+    //decode once and share the buffer between every bank
+    auto sample = SampleBuffer::loadFromFile(formatManager, url.getLocalFile());
+    
+    if(sample == nullptr)
+    {
+        return;
+    }
+    
+    setMainSample(sample);
+    sliceWhenAnalysed = false; //a file isn't cut up until it's asked for
+}
+
+void SampleChopperAudioProcessor::setMainSample(SampleBuffer::Ptr sample, const BeatGrid& knownGrid)
 {
     for(int i = 0; i < bankList.size(); i++)
     {
-        bankList[i]->loadURL(url);
+        bankList[i]->setSample(sample);
+    }
+    
+    if(knownGrid.isValid())
+    {
+        sampleAnalyser.setBeatGrid(knownGrid);
+    }else
+    {
+        sampleAnalyser.analyse(sample);
+    }
+    
+    for(auto& speedPerBpm : bankTempoSync) //the old slices don't line up with the new file
+    {
+        speedPerBpm = 0.0;
     }
     
+    undoManager.clearUndoHistory(); //nor do the regions the history would put back
+    
     fileFilled = true;
+    sampleVersion++;
+}
+
+void SampleChopperAudioProcessor::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    if(source != &sampleAnalyser || !sliceWhenAnalysed)
+    {
+        return;
+    }
     
+    sliceWhenAnalysed = false;
     
+    if(!sliceToBeatGrid(1, 0.0)) //a beat per bank
+    {
+        sliceEvenly();
+    }
+}
+
+void SampleChopperAudioProcessor::sliceEvenly()
+{
+    undoManager.beginNewTransaction("Slice");
+    
+    for(int i = 0; i < numberOfSampleBanks; i++)
+    {
+        setBankLoopRegion(i, static_cast<float>(i) / numberOfSampleBanks, static_cast<float>(i + 1) / numberOfSampleBanks);
+    }
 }
 
 juce::AudioFormatManager* SampleChopperAudioProcessor::getFormatManager()
@@ -247,6 +780,98 @@ std::vector<Bank*> SampleChopperAudioProcessor::getBanksList()
     return bankList;
 }
 
+bool SampleChopperAudioProcessor::sliceToBeatGrid(int divisionsPerBeat, double fromSeconds)
+{
+    auto sample = bankList[0]->getSample();
+    const auto grid = sampleAnalyser.getBeatGrid();
+    
+    if(sample == nullptr || !grid.isValid())
+    {
+        return false;
+    }
+    
+    const auto slices = Slicer::fromBeatGrid(grid, sample->getSampleRate(), sample->getNumSamples(), divisionsPerBeat);
+    const auto fromSample = static_cast<juce::int64>(fromSeconds * sample->getSampleRate());
+    
+    auto slice = std::find_if(slices.begin(), slices.end(), [fromSample](const GridSlice& gridSlice)
+    {
+        return gridSlice.slice.start >= fromSample;
+    });
+    
+    if(slice == slices.end())
+    {
+        return false;
+    }
+    
+    const double numSamples = sample->getNumSamples();
+    
+    undoManager.beginNewTransaction("Slice");
+    
+    for(int i = 0; i < numberOfSampleBanks && slice != slices.end(); i++, slice++)
+    {
+        setBankLoopRegion(i, static_cast<float>(slice->slice.start / numSamples), static_cast<float>(slice->slice.end / numSamples), slice->speedPerBpm);
+    }
+    
+    return true;
+}
+
+void SampleChopperAudioProcessor::setBankLoopRegion(int bankIndex, float start, float end, double speedPerBpm)
+{
+    if(!juce::isPositiveAndBelow(bankIndex, numberOfSampleBanks))
+    {
+        return;
+    }
+    
+    LoopRegionEdit::Region before {bankList[bankIndex]->loopRegion, getBankTempoSync(bankIndex)};
+    LoopRegionEdit::Region after {{}, speedPerBpm};
+    after.interval.start(start);
+    after.interval.end(end);
+    
+    undoManager.perform(new LoopRegionEdit(*this, bankIndex, before, after));
+}
+
+void SampleChopperAudioProcessor::setBankTempoSync(int bankIndex, double speedPerBpm)
+{
+    if(juce::isPositiveAndBelow(bankIndex, numberOfSampleBanks))
+    {
+        bankTempoSync[static_cast<size_t>(bankIndex)] = speedPerBpm;
+    }
+}
+
+double SampleChopperAudioProcessor::getBankTempoSync(int bankIndex) const
+{
+    return juce::isPositiveAndBelow(bankIndex, numberOfSampleBanks) ? bankTempoSync[static_cast<size_t>(bankIndex)].load() : 0.0;
+}
+
+void SampleChopperAudioProcessor::setBankNote(int bankIndex, int noteNumber)
+{
+    for(auto& mappedBank : noteToBank) //a bank only listens to one note
+    {
+        if(mappedBank == bankIndex)
+        {
+            mappedBank = -1;
+        }
+    }
+    
+    if(juce::isPositiveAndBelow(noteNumber, 128))
+    {
+        noteToBank[noteNumber] = bankIndex;
+    }
+}
+
+int SampleChopperAudioProcessor::getBankNote(int bankIndex) const
+{
+    for(int note = 0; note < 128; note++)
+    {
+        if(noteToBank[note] == bankIndex)
+        {
+            return note;
+        }
+    }
+    
+    return -1;
+}
+
 //==============================================================================
 // This creates new instances of the plugin..
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -274,8 +899,333 @@ juce::AudioProcessorValueTreeState::ParameterLayout SampleChopperAudioProcessor:
         1},
         "Show Transients", true));
     
+    //send buses, shared by every bank
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+        "delayTime",
+        1},
+        "Delay Time", juce::StringArray{"1/16", "1/8", "1/8 Dotted", "1/4", "1/4 Dotted", "1/2", "1 Bar"}, 2));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "delayFeedback",
+        1},
+        "Delay Feedback", 0.0f, 0.95f, 0.35f));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "delayDamping",
+        1},
+        "Delay Damping", 0.0f, 1.0f, 0.3f));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "delayReturn",
+        1},
+        "Delay Return", 0.0f, 1.0f, 0.8f));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "reverbDecay",
+        1},
+        "Reverb Decay", juce::NormalisableRange<float>(0.2f, 4.0f, 0.01f), 1.5f));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "reverbReturn",
+        1},
+        "Reverb Return", 0.0f, 1.0f, 0.8f));
+    
+    //samples between modulation control points for every bank, lower follows fast LFOs closer and costs more
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+        "modControlRate",
+        1},
+        "Modulation Control Rate", juce::StringArray{"8", "16", "32", "64", "128"}, 2));
+    
+    //master bus, each stage is off until it's switched on
+    juce::NormalisableRange<float> masterCutoffRange(20.0f, 20000.0f, 0.1f);
+    masterCutoffRange.setSkewForCentre(1000.0f);
+    
+    params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{
+        "masterFilterOn",
+        1},
+        "Master Filter", false));
+    
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+        "masterFilterMode",
+        1},
+        "Master Filter Mode", juce::StringArray{"LP 12", "LP 24", "HP 12", "HP 24", "BP 12", "BP 24"}, 1));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "masterCutoff",
+        1},
+        "Master Cutoff", masterCutoffRange, 20000.0f));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "masterResonance",
+        1},
+        "Master Resonance", 0.0f, 1.0f, 0.0f));
+    
+    params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{
+        "masterCompOn",
+        1},
+        "Master Compressor", false));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "masterThreshold",
+        1},
+        "Master Threshold", juce::NormalisableRange<float>(-48.0f, 0.0f, 0.1f), -12.0f));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "masterRatio",
+        1},
+        "Master Ratio", juce::NormalisableRange<float>(1.0f, 20.0f, 0.1f), 4.0f));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "masterAttack",
+        1},
+        "Master Attack", juce::NormalisableRange<float>(0.1f, 100.0f, 0.1f), 10.0f));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "masterRelease",
+        1},
+        "Master Release", juce::NormalisableRange<float>(10.0f, 1000.0f, 1.0f), 100.0f));
+    
+    params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{
+        "masterSatOn",
+        1},
+        "Master Saturator", false));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "masterSaturation",
+        1},
+        "Master Saturation", juce::NormalisableRange<float>(0.0f, 24.0f, 0.1f), 6.0f));
+    
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+        "masterOversampling",
+        1},
+        "Master Oversampling", juce::StringArray{"Off", "2x", "4x", "8x"}, 1));
+    
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+        "masterOversamplingFilter",
+        1},
+        "Master Oversampling Filter", juce::StringArray{"Polyphase IIR", "FIR"}, 0));
+    
+    params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{
+        "masterLimiterOn",
+        1},
+        "Master Limiter", false));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+        "masterCeiling",
+        1},
+        "Master Ceiling", juce::NormalisableRange<float>(-24.0f, 0.0f, 0.1f), -0.3f));
+    
+    //Bank parameters
+    for(int i = 1; i <= numberOfSampleBanks; i++)
+    {
+        juce::String bankName = "Bank " + juce::String::charToString('A' + i - 1) + " ";
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "Volume"),
+            1},
+            bankName + "Volume", 0.0f, 1.0f, 0.5f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "Attack"),
+            1},
+            bankName + "Attack", juce::NormalisableRange<float>(0.0f, 2.5f, 0.001f), 0.1f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "Decay"),
+            1},
+            bankName + "Decay", juce::NormalisableRange<float>(0.0f, 2.5f, 0.001f), 0.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "Sustain"),
+            1},
+            bankName + "Sustain", 0.0f, 1.0f, 1.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "Release"),
+            1},
+            bankName + "Release", juce::NormalisableRange<float>(0.0f, 5.0f, 0.001f), 0.2f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "Pan"),
+            1},
+            bankName + "Pan", -1.0f, 1.0f, 0.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "Pitch"),
+            1},
+            bankName + "Pitch", juce::NormalisableRange<float>(-12.0f, 12.0f, 0.01f), 0.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+            getBankParameterID(i, "PlayMode"),
+            1},
+            bankName + "Play Mode", juce::StringArray{"Forward", "Reverse", "Ping Pong", "Granular"}, 0));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "StartOffset"),
+            1},
+            bankName + "Start Offset", 0.0f, 1.0f, 0.0f));
+        
+        //banks in the same group cut each other off, e.g. open and closed hats
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+            getBankParameterID(i, "ChokeGroup"),
+            1},
+            bankName + "Choke Group", juce::StringArray{"None", "1", "2", "3", "4"}, 0));
+        
+        //insert effects, each slot is off until it's switched on
+        juce::NormalisableRange<float> cutoffRange(20.0f, 20000.0f, 0.1f);
+        cutoffRange.setSkewForCentre(1000.0f);
+        
+        params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{
+            getBankParameterID(i, "FilterOn"),
+            1},
+            bankName + "Filter", false));
+        
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+            getBankParameterID(i, "FilterType"),
+            1},
+            bankName + "Filter Type", juce::StringArray{"Low Pass", "Band Pass", "High Pass"}, 0));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "Cutoff"),
+            1},
+            bankName + "Cutoff", cutoffRange, 5000.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "Resonance"),
+            1},
+            bankName + "Resonance", juce::NormalisableRange<float>(0.3f, 10.0f, 0.01f), 0.707f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "FilterEnv"),
+            1},
+            bankName + "Filter Envelope", -1.0f, 1.0f, 0.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{
+            getBankParameterID(i, "DriveOn"),
+            1},
+            bankName + "Drive On", false));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "Drive"),
+            1},
+            bankName + "Drive", juce::NormalisableRange<float>(0.0f, 36.0f, 0.1f), 12.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{
+            getBankParameterID(i, "CrushOn"),
+            1},
+            bankName + "Bitcrush", false));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "Bits"),
+            1},
+            bankName + "Bits", juce::NormalisableRange<float>(1.0f, 16.0f, 0.1f), 8.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{
+            getBankParameterID(i, "Downsample"),
+            1},
+            bankName + "Downsample", 1, 32, 1));
+        
+        params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{
+            getBankParameterID(i, "ShaperOn"),
+            1},
+            bankName + "Transient Shaper", false));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "ShaperAttack"),
+            1},
+            bankName + "Shaper Attack", -1.0f, 1.0f, 0.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "ShaperSustain"),
+            1},
+            bankName + "Shaper Sustain", -1.0f, 1.0f, 0.0f));
+        
+        //modulation matrix, every slot is off until it has a source
+        for(int slot = 1; slot <= ModulationMatrix::numberOfSlots; slot++)
+        {
+            const juce::String slotID = "Mod" + juce::String(slot);
+            const juce::String slotName = bankName + "Mod " + juce::String(slot);
+            
+            params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+                getBankParameterID(i, slotID + "Source"),
+                1},
+                slotName + " Source", juce::StringArray{"None", "LFO", "Envelope", "Velocity", "Random"}, 0));
+            
+            params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+                getBankParameterID(i, slotID + "Dest"),
+                1},
+                slotName + " Destination", juce::StringArray{"Pitch", "Cutoff", "Pan", "Start Offset"}, 0));
+            
+            params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+                getBankParameterID(i, slotID + "Amount"),
+                1},
+                slotName + " Amount", -1.0f, 1.0f, 0.0f));
+        }
+        
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+            getBankParameterID(i, "LfoRate"),
+            1},
+            bankName + "LFO Rate", juce::StringArray{"1/16", "1/8", "1/4", "1/2", "1 Bar", "2 Bars", "4 Bars"}, 2));
+        
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+            getBankParameterID(i, "LfoShape"),
+            1},
+            bankName + "LFO Shape", juce::StringArray{"Sine", "Triangle", "Saw", "Square", "Sample & Hold"}, 0));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "ModAttack"),
+            1},
+            bankName + "Mod Attack", juce::NormalisableRange<float>(0.0f, 2.5f, 0.001f), 0.01f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "ModDecay"),
+            1},
+            bankName + "Mod Decay", juce::NormalisableRange<float>(0.0f, 5.0f, 0.001f), 0.5f));
+        
+        //granular play mode
+        juce::NormalisableRange<float> grainDensityRange(1.0f, 200.0f, 0.1f);
+        grainDensityRange.setSkewForCentre(30.0f);
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "GrainDensity"),
+            1},
+            bankName + "Grain Density", grainDensityRange, 40.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "GrainSize"),
+            1},
+            bankName + "Grain Size", juce::NormalisableRange<float>(0.005f, 0.5f, 0.001f), 0.08f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "GrainSpray"),
+            1},
+            bankName + "Grain Spray", 0.0f, 1.0f, 0.1f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "GrainPitch"),
+            1},
+            bankName + "Grain Pitch", juce::NormalisableRange<float>(-24.0f, 24.0f, 0.01f), 0.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{
+            getBankParameterID(i, "GrainWindow"),
+            1},
+            bankName + "Grain Window", juce::StringArray{"Hann", "Tukey"}, 0));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "DelaySend"),
+            1},
+            bankName + "Delay Send", 0.0f, 1.0f, 0.0f));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{
+            getBankParameterID(i, "ReverbSend"),
+            1},
+            bankName + "Reverb Send", 0.0f, 1.0f, 0.0f));
+    }
+    
     return {params.begin(), params.end()};
 }
 
-
-
+juce::String SampleChopperAudioProcessor::getBankParameterID(int bankNumber, const juce::String& parameterName)
+{
+    return "bank" + juce::String(bankNumber) + parameterName;
+}
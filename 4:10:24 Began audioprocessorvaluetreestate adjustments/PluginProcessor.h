@@ -11,12 +11,24 @@
 #include <JuceHeader.h>
 #include <strings.h>
 #include "Bank.h"
+#include "SequencerEngine.h"
+#include "PerformanceMonitor.h"
+#include "SummingBus.h"
+#include "MasterEffects.h"
+#include "SendEffects.h"
+#include "SampleAnalyser.h"
+#include "Slicer.h"
+#include "InputRecorder.h"
+#include "UndoableEdits.h"
 #include <juce_audio_processors/juce_audio_processors.h>
 
 //==============================================================================
 /**
 */
-class SampleChopperAudioProcessor  : public juce::AudioProcessor
+class SampleChopperAudioProcessor  : public juce::AudioProcessor,
+                                     private juce::AudioProcessorValueTreeState::Listener,
+                                     private juce::AsyncUpdater,
+                                     private juce::ChangeListener
 {
 public:
     //==============================================================================
@@ -61,6 +73,16 @@ public:
    //banks
     void loadURLS(juce::URL& url);
     
+    //message thread, gives every bank a sample that's already decoded and starts analysing it, unless its
+    //grid is already known. Notes that are sounding finish on the old sample, the sequencer carries on
+    void setMainSample(SampleBuffer::Ptr sample, const BeatGrid& knownGrid = {});
+    
+    //goes up every time the banks are given a new sample, so the GUI can tell one it didn't load itself
+    int getSampleVersion() const
+    {
+        return sampleVersion;
+    }
+    
     juce::AudioFormatManager* getFormatManager();
     
     //receives a specific bank number
@@ -91,14 +113,222 @@ public:
         
     }
     
-    juce::AudioProcessorValueTreeState apvts;
+    //parameter changes, loop regions, slicing and steps. Every edit is kept as its before and after values and the
+    //unit limit drops the oldest transactions past it, so the history stays bounded however long the session is
+    juce::UndoManager undoManager {maxUndoUnits, minUndoTransactions};
+    static constexpr int maxUndoUnits = 64 * 1024;
+    static constexpr int minUndoTransactions = 30;
+    
+    juce::AudioProcessorValueTreeState apvts; //not given the undo manager, parameter edits go in through gestureRecorder
+    ParameterGestureRecorder gestureRecorder;
     juce::ValueTree settingsTree;
     
+    //parameter ID for a bank's parameter, e.g. getBankParameterID(1, "Volume") == "bank1Volume"
+    static juce::String getBankParameterID(int bankNumber, const juce::String& parameterName);
+    
+    static constexpr int numberOfSampleBanks = 5; //banks with a GUI (the listener bank has no parameters)
+    
+    //MIDI note that triggers a bank (0-4), defaults to a drum pad layout starting at C1 (36)
+    void setBankNote(int bankIndex, int noteNumber);
+    int getBankNote(int bankIndex) const;
+    
+    SequencerEngine& getSequencerEngine()
+    {
+        return sequencerEngine;
+    }
+    
+    PerformanceMonitor& getPerformanceMonitor()
+    {
+        return performanceMonitor;
+    }
+    
+    //output bus for each bank's aux output, bus 0 is the main mix
+    static int getBankBusIndex(int bankIndex)
+    {
+        return bankIndex + 1;
+    }
+    
+    //banks can be routed to their own stem buffer instead of straight into the output
+    SummingBus& getSummingBus()
+    {
+        return summingBus;
+    }
+    
+    //tempo and beat grid of the loaded sample, worked out in the background after loadURLS
+    SampleAnalyser& getSampleAnalyser()
+    {
+        return sampleAnalyser;
+    }
+    
+    //cuts the sample along its beat grid and gives banks A to E the first slices at or after fromSeconds, each one
+    //playing in time with the sequencer's tempo. Returns false when there's no sample or no grid yet
+    bool sliceToBeatGrid(int divisionsPerBeat, double fromSeconds);
+    
+    //records the host's input, a finished take replaces the sample and is sliced once it's been analysed
+    InputRecorder& getInputRecorder()
+    {
+        return inputRecorder;
+    }
+    
+    //message thread, goes through the undo manager, call undoManager.beginNewTransaction first to start a new undo step
+    void setBankLoopRegion(int bankIndex, float start, float end, double speedPerBpm = 0.0);
+    
+    //a bank playing a grid slice runs at speedPerBpm * the current tempo (see GridSlice), 0 for its own speed
+    void setBankTempoSync(int bankIndex, double speedPerBpm);
+    double getBankTempoSync(int bankIndex) const;
+    
 
 private:
     
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     
+    //pushes the current parameter values into the banks, called at the start of every block
+    void updateBankParameters();
+    
+    //same for the master bus, also picks up the oversampling latency for handleAsyncUpdate to report
+    void updateMasterParameters();
+    
+    //the reverb's impulse response is rebuilt on the message thread when its decay changes, and a new
+    //latency is reported from there too, as some wrappers tell the host about it straight away
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    std::atomic<bool> reverbDecayChanged {false};
+    std::atomic<int> masterLatency {0};
+    
+    //a recorded take is sliced along its beat grid when one's found, or into equal parts when it isn't
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override; //the sample analyser
+    void sliceEvenly();
+    bool sliceWhenAnalysed = false;
+    int sampleVersion = 0;
+    
+    //adds every loaded bank with a sounding voice between two events in the block, returns false if none were
+    bool renderBanks(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void addMidiEvents(const juce::MidiBuffer& midiMessages);
+    void handleBankEvent(const BankEvent& event);
+    void chokeGroup(int bankIndex); //fast releases the other banks in this bank's choke group
+    
+    SequencerEngine sequencerEngine;
+    PerformanceMonitor performanceMonitor;
+    SummingBus summingBus;
+    MasterEffects masterEffects;
+    SendEffects sendEffects;
+    SampleAnalyser sampleAnalyser;
+    InputRecorder inputRecorder;
+    
+    //per block views of the main output and the banks' aux outputs, they point into the host's buffer
+    juce::AudioBuffer<float> mainOutput;
+    std::array<juce::AudioBuffer<float>, numberOfSampleBanks> bankBusOutputs;
+    std::array<bool, numberOfSampleBanks> bankBusEnabled {}; //cached in prepareToPlay, hosts only change layouts while stopped
+    
+    //MIDI and sequencer notes for the current block, reserved in prepareToPlay
+    std::vector<BankEvent> blockEvents;
+    static constexpr int maxEventsPerBlock = 512;
+    
+    //GridSlice::speedPerBpm of the slice each bank is playing, 0 when it isn't synced to the tempo
+    std::array<std::atomic<double>, numberOfSampleBanks> bankTempoSync {};
+    
+    //choke groups, rebuilt from the parameters every block. Group 0 is no group, each group's mask has
+    //a bit per bank in it so a note only touches the banks it chokes
+    static constexpr int numberOfChokeGroups = 4;
+    std::array<juce::uint32, numberOfChokeGroups + 1> chokeGroupMasks {};
+    std::array<int, numberOfSampleBanks> bankChokeGroups {};
+    
+    //note number -> bank index, -1 when a note isn't mapped
+    std::array<std::atomic<int>, 128> noteToBank;
+    
+    //raw parameter values cached in the constructor so the audio thread never looks up strings
+    struct BankParameterPointers
+    {
+        std::atomic<float>* volume = nullptr;
+        std::atomic<float>* attack = nullptr;
+        std::atomic<float>* decay = nullptr;
+        std::atomic<float>* sustain = nullptr;
+        std::atomic<float>* release = nullptr;
+        std::atomic<float>* pan = nullptr;
+        std::atomic<float>* pitch = nullptr;
+        std::atomic<float>* playMode = nullptr;
+        std::atomic<float>* startOffset = nullptr;
+        std::atomic<float>* chokeGroup = nullptr;
+        
+        //insert effects
+        std::atomic<float>* filterOn = nullptr;
+        std::atomic<float>* filterType = nullptr;
+        std::atomic<float>* cutoff = nullptr;
+        std::atomic<float>* resonance = nullptr;
+        std::atomic<float>* filterEnvelope = nullptr;
+        std::atomic<float>* driveOn = nullptr;
+        std::atomic<float>* drive = nullptr;
+        std::atomic<float>* crushOn = nullptr;
+        std::atomic<float>* bits = nullptr;
+        std::atomic<float>* downsample = nullptr;
+        std::atomic<float>* shaperOn = nullptr;
+        std::atomic<float>* shaperAttack = nullptr;
+        std::atomic<float>* shaperSustain = nullptr;
+        
+        //modulation matrix
+        std::array<std::atomic<float>*, ModulationMatrix::numberOfSlots> modSource {};
+        std::array<std::atomic<float>*, ModulationMatrix::numberOfSlots> modDestination {};
+        std::array<std::atomic<float>*, ModulationMatrix::numberOfSlots> modAmount {};
+        std::atomic<float>* lfoRate = nullptr;
+        std::atomic<float>* lfoShape = nullptr;
+        std::atomic<float>* modAttack = nullptr;
+        std::atomic<float>* modDecay = nullptr;
+        
+        //granular play mode
+        std::atomic<float>* grainDensity = nullptr;
+        std::atomic<float>* grainSize = nullptr;
+        std::atomic<float>* grainSpray = nullptr;
+        std::atomic<float>* grainPitch = nullptr;
+        std::atomic<float>* grainWindow = nullptr;
+        
+        //sends
+        std::atomic<float>* delaySend = nullptr;
+        std::atomic<float>* reverbSend = nullptr;
+    };
+    
+    std::vector<BankParameterPointers> bankParameters;
+    
+    std::atomic<float>* masterGainParameter = nullptr;
+    std::atomic<float>* globalSpeedParameter = nullptr;
+    
+    struct MasterParameterPointers
+    {
+        std::atomic<float>* filterOn = nullptr;
+        std::atomic<float>* filterMode = nullptr;
+        std::atomic<float>* cutoff = nullptr;
+        std::atomic<float>* resonance = nullptr;
+        std::atomic<float>* compressorOn = nullptr;
+        std::atomic<float>* threshold = nullptr;
+        std::atomic<float>* ratio = nullptr;
+        std::atomic<float>* attack = nullptr;
+        std::atomic<float>* release = nullptr;
+        std::atomic<float>* saturatorOn = nullptr;
+        std::atomic<float>* saturation = nullptr;
+        std::atomic<float>* oversampling = nullptr;
+        std::atomic<float>* oversamplingFilter = nullptr;
+        std::atomic<float>* limiterOn = nullptr;
+        std::atomic<float>* ceiling = nullptr;
+    };
+    
+    MasterParameterPointers masterParameters;
+    
+    std::atomic<float>* delayTimeParameter = nullptr;
+    std::atomic<float>* delayFeedbackParameter = nullptr;
+    std::atomic<float>* delayDampingParameter = nullptr;
+    std::atomic<float>* delayReturnParameter = nullptr;
+    std::atomic<float>* reverbDecayParameter = nullptr;
+    std::atomic<float>* reverbReturnParameter = nullptr;
+    
+    //note lengths for the delay time choice, in beats
+    static constexpr std::array<float, 7> delayTimeBeats {0.25f, 0.5f, 0.75f, 1.0f, 1.5f, 2.0f, 4.0f};
+    
+    //LFO cycle lengths for the rate choice, in beats, and the modulation control rate choice in samples
+    static constexpr std::array<double, 7> lfoRateBeats {0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0};
+    static constexpr std::array<int, 5> modulationControlIntervals {8, 16, 32, 64, 128};
+    std::atomic<float>* modControlRateParameter = nullptr;
+    
+    juce::SmoothedValue<float> masterGainSmoothed;
+    
     int numberOfBanks = 6;
     
     std::vector<Bank*> bankList = {&bank1, &bank2, &bank3, &bank4, &bank5, &listenerBank}; //used to avoid repeating code
@@ -115,8 +345,6 @@ private:
     
     juce::AudioFormatManager formatManager;
     
-    juce::MixerAudioSource mixerSource;
-    
     juce::String fileName;
     
     bool playing;
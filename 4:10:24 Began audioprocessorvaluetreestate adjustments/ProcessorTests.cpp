@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    ProcessorTests.cpp
+    Created: 18 Oct 2024 1:15:33pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+class ProcessorTests : public juce::UnitTest
+{
+public:
+    ProcessorTests() : juce::UnitTest("Processor", "Processor") {}
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 44100.0;
+        constexpr int blockSize = 512;
+
+        auto processor = std::make_unique<SampleChopperAudioProcessor>();
+
+        //half a second of a loud sine in every bank, so a note would be heard
+        juce::AudioBuffer<float> tone(2, static_cast<int>(sampleRate / 2));
+
+        for(int i = 0; i < tone.getNumSamples(); i++)
+        {
+            const auto value = 0.5f * std::sin(juce::MathConstants<float>::twoPi * 220.0f * static_cast<float>(i / sampleRate));
+            tone.setSample(0, i, value);
+            tone.setSample(1, i, value);
+        }
+
+        SampleBuffer::Ptr sample = new SampleBuffer(tone, sampleRate);
+
+        for(int i = 1; i <= 6; i++)
+        {
+            processor->getBank(i)->setSample(sample);
+            processor->getBank(i)->setLoopRegion(0.0f, 1.0f);
+        }
+
+        processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor->prepareToPlay(sampleRate, blockSize);
+
+        const int numInputChannels = processor->getTotalNumInputChannels();
+        juce::AudioBuffer<float> buffer(juce::jmax(numInputChannels, processor->getTotalNumOutputChannels()), blockSize);
+        juce::MidiBuffer midi;
+
+        //the host's input, written into the channels the input and the main output share
+        auto fillInput = [&](int block)
+        {
+            buffer.clear();
+
+            for(int channel = 0; channel < numInputChannels; channel++)
+            {
+                for(int i = 0; i < blockSize; i++)
+                {
+                    buffer.setSample(channel, i, 0.8f * std::sin(0.05f * static_cast<float>(block * blockSize + i)));
+                }
+            }
+        };
+
+        beginTest("The host's input isn't passed through when nothing is playing");
+        {
+            expectGreaterThan(numInputChannels, 0, "the processor has an input to record from");
+
+            float loudest = 0.0f;
+
+            for(int block = 0; block < 20; block++)
+            {
+                fillInput(block);
+                processor->processBlock(buffer, midi);
+                loudest = juce::jmax(loudest, processor->getBusBuffer(buffer, false, 0).getMagnitude(0, blockSize));
+            }
+
+            expectEquals(loudest, 0.0f);
+        }
+
+        beginTest("A note on top of the input is still heard");
+        {
+            midi.addEvent(juce::MidiMessage::noteOn(1, 36, static_cast<juce::uint8>(127)), 0); //bank A
+            float loudest = 0.0f;
+
+            for(int block = 20; block < 28; block++) //through the default 100ms attack
+            {
+                fillInput(block);
+                processor->processBlock(buffer, midi);
+                midi.clear();
+                loudest = juce::jmax(loudest, processor->getBusBuffer(buffer, false, 0).getMagnitude(0, blockSize));
+            }
+
+            expectGreaterThan(loudest, 0.01f);
+        }
+
+        processor->releaseResources();
+    }
+};
+
+static ProcessorTests processorTests;
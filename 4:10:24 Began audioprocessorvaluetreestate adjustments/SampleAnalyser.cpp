@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    SampleAnalyser.cpp
+    Created: 15 Oct 2024 10:12:40am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "SampleAnalyser.h"
+#include "SoundTouch/BPMDetect.h"
+
+SampleAnalyser::SampleAnalyser()
+    : juce::Thread("Sample Analyser")
+{
+}
+
+SampleAnalyser::~SampleAnalyser()
+{
+    stopThread(2000);
+}
+
+void SampleAnalyser::analyse(SampleBuffer::Ptr sample)
+{
+    {
+        const juce::ScopedLock scopedLock(lock);
+        pendingSample = sample;
+        generation++;
+    }
+
+    if(!isThreadRunning())
+    {
+        startThread(juce::Thread::Priority::low);
+    }
+
+    notify();
+}
+
+void SampleAnalyser::setBeatGrid(const BeatGrid& grid)
+{
+    {
+        const juce::ScopedLock scopedLock(lock);
+        pendingSample = nullptr;
+        beatGrid = grid;
+        generation++;
+    }
+
+    version++;
+    sendChangeMessage();
+}
+
+BeatGrid SampleAnalyser::getBeatGrid() const
+{
+    const juce::ScopedLock scopedLock(lock);
+    return beatGrid;
+}
+
+int SampleAnalyser::getVersion() const
+{
+    return version.load();
+}
+
+void SampleAnalyser::run()
+{
+    while(!threadShouldExit())
+    {
+        SampleBuffer::Ptr sample;
+        int sampleGeneration = 0;
+
+        {
+            const juce::ScopedLock scopedLock(lock);
+            std::swap(sample, pendingSample);
+            sampleGeneration = generation;
+        }
+
+        if(sample == nullptr)
+        {
+            wait(-1);
+            continue;
+        }
+
+        //a newer sample or grid arriving cancels this one, a new sample is picked up on the next time round
+        auto grid = analyseSample(*sample, [this, sampleGeneration]
+        {
+            const juce::ScopedLock scopedLock(lock);
+            return threadShouldExit() || generation != sampleGeneration;
+        });
+
+        if(threadShouldExit())
+        {
+            break;
+        }
+
+        {
+            const juce::ScopedLock scopedLock(lock);
+
+            if(generation != sampleGeneration)
+            {
+                continue;
+            }
+
+            beatGrid = grid;
+        }
+
+        version++;
+        sendChangeMessage();
+    }
+}
+
+//runs BPMDetect over part of the sample, beat positions come back in seconds from the start of the excerpt
+static bool detectExcerpt(const SampleBuffer& sample, int start, int length, int chunkSize,
+                          const std::function<bool()>& shouldStop, double& bpm, std::vector<float>& positions, std::vector<float>& strengths)
+{
+    const int numChannels = sample.getNumChannels();
+
+    //mono is all BPMDetect needs, and halves the work of its decimation
+    soundtouch::BPMDetect detector(1, juce::roundToInt(sample.getSampleRate()));
+    std::vector<float> mono(static_cast<size_t>(juce::jmin(chunkSize, length)));
+
+    for(int offset = 0; offset < length; offset += chunkSize)
+    {
+        if(shouldStop && shouldStop())
+        {
+            return false;
+        }
+
+        const int chunkLength = juce::jmin(chunkSize, length - offset);
+        const int position = start + offset;
+
+        //the downmix is vectorised, BPMDetect works on this copy in place
+        juce::FloatVectorOperations::copy(mono.data(), sample.getReadPointer(0) + position, chunkLength);
+
+        if(numChannels > 1)
+        {
+            juce::FloatVectorOperations::add(mono.data(), sample.getReadPointer(1) + position, chunkLength);
+            juce::FloatVectorOperations::multiply(mono.data(), 0.5f, chunkLength);
+        }
+
+        detector.inputSamples(mono.data(), chunkLength);
+    }
+
+    bpm = detector.getBpm();
+    const int numBeats = detector.getBeats(nullptr, nullptr, 0);
+
+    positions.resize(static_cast<size_t>(numBeats));
+    strengths.resize(static_cast<size_t>(numBeats));
+    detector.getBeats(positions.data(), strengths.data(), numBeats);
+
+    return true;
+}
+
+BeatGrid SampleAnalyser::analyseSample(const SampleBuffer& sample, const std::function<bool()>& shouldStop)
+{
+    const int numSamples = sample.getNumSamples();
+    const double sampleRate = sample.getSampleRate();
+
+    //BPMDetect decimates to 1kHz and refuses anything it can't
+    if(numSamples <= 0 || sample.getNumChannels() <= 0 || sampleRate < 8000.0)
+    {
+        return {};
+    }
+
+    const double lengthInSeconds = sample.getLengthInSeconds();
+    const int excerptLength = juce::roundToInt(excerptSeconds * sampleRate);
+
+    //short enough to take in one go
+    if(numSamples <= excerptLength * 2)
+    {
+        double bpm = 0.0;
+        std::vector<float> positions, strengths;
+
+        if(!detectExcerpt(sample, 0, numSamples, chunkSize, shouldStop, bpm, positions, strengths))
+        {
+            return {};
+        }
+
+        return BeatGrid::fromBeats(bpm, positions.data(), strengths.data(), static_cast<int>(positions.size()), lengthInSeconds);
+    }
+
+    //the correlation cost is per second of audio, so long files are only analysed around a quarter and three
+    //quarters of the way through, away from intros and outros, and the grid is stretched across the rest
+    const int starts[] = {numSamples / 4 - excerptLength / 2, (numSamples / 4) * 3 - excerptLength / 2};
+    double bpms[2] = {0.0, 0.0};
+    std::vector<float> positions[2], strengths[2];
+
+    for(int i = 0; i < 2; i++)
+    {
+        if(!detectExcerpt(sample, starts[i], excerptLength, chunkSize, shouldStop, bpms[i], positions[i], strengths[i]))
+        {
+            return {};
+        }
+    }
+
+    double bpm = 0.0;
+
+    if(bpms[0] > 0.0 && bpms[1] > 0.0)
+    {
+        bpm = (bpms[0] + bpms[1]) * 0.5;
+
+        //each excerpt pins down a beat to within a few ms, counting the beats between them gives the
+        //tempo far more precisely than either excerpt can on its own, which stops the grid drifting
+        const double beatLength = 60.0 / bpm;
+        const double anchors[] = {starts[0] / sampleRate + BeatGrid::fromBeats(bpm, positions[0].data(), strengths[0].data(), static_cast<int>(positions[0].size()), excerptSeconds).firstBeat,
+                                  starts[1] / sampleRate + BeatGrid::fromBeats(bpm, positions[1].data(), strengths[1].data(), static_cast<int>(positions[1].size()), excerptSeconds).firstBeat};
+        const double beatsBetween = std::round((anchors[1] - anchors[0]) / beatLength);
+
+        if(beatsBetween > 0.0)
+        {
+            const double refined = beatsBetween * 60.0 / (anchors[1] - anchors[0]);
+
+            if(std::abs(refined / bpm - 1.0) < 0.01) //any further out and a beat was miscounted, keep the estimate
+            {
+                bpm = refined;
+            }
+        }
+    }
+    else
+    {
+        bpm = juce::jmax(bpms[0], bpms[1]);
+    }
+
+    //both excerpts' beats, moved to seconds from the start of the file
+    std::vector<float> allPositions, allStrengths;
+
+    for(int i = 0; i < 2; i++)
+    {
+        const float offset = static_cast<float>(starts[i] / sampleRate);
+
+        for(size_t beat = 0; beat < positions[i].size(); beat++)
+        {
+            allPositions.push_back(positions[i][beat] + offset);
+            allStrengths.push_back(strengths[i][beat]);
+        }
+    }
+
+    return BeatGrid::fromBeats(bpm, allPositions.data(), allStrengths.data(), static_cast<int>(allPositions.size()), lengthInSeconds);
+}
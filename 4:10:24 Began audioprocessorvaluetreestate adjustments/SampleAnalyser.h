@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    SampleAnalyser.h
+    Created: 15 Oct 2024 10:12:40am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleBuffer.h"
+#include "BeatGrid.h"
+
+//Works out the tempo and beat grid of a newly loaded sample on a background thread, using SoundTouch's BPMDetect.
+//The GUI polls getVersion and picks up the new grid when it changes, change listeners are told on the message thread.
+class SampleAnalyser : public juce::ChangeBroadcaster,
+                       private juce::Thread
+{
+public:
+    SampleAnalyser();
+    ~SampleAnalyser() override;
+
+    //message thread, starts the thread on first use and replaces any analysis still running
+    void analyse(SampleBuffer::Ptr sample);
+
+    //message thread, for a sample whose tempo is already known, e.g. a rendered pattern. Cancels any analysis
+    void setBeatGrid(const BeatGrid& grid);
+
+    BeatGrid getBeatGrid() const;
+    int getVersion() const; //goes up every time a new grid is ready
+
+    //the analysis itself, on whichever thread calls it, shouldStop is checked between chunks
+    static BeatGrid analyseSample(const SampleBuffer& sample, const std::function<bool()>& shouldStop = {});
+
+private:
+    void run() override;
+
+    //samples handed to BPMDetect at a time, it keeps its own decimated history between calls
+    static constexpr int chunkSize = 65536;
+
+    //files longer than two of these are only analysed in two excerpts, see analyseSample
+    static constexpr double excerptSeconds = 30.0;
+
+    juce::CriticalSection lock;
+    SampleBuffer::Ptr pendingSample;
+    BeatGrid beatGrid;
+    int generation = 0; //under the lock, goes up with every new sample or grid so a stale analysis is dropped
+    std::atomic<int> version {0};
+};
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    SampleBuffer.cpp
+    Created: 5 Oct 2024 11:02:13am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "SampleBuffer.h"
+
+SampleBuffer::SampleBuffer(juce::AudioFormatReader& reader)
+{
+    numSamples = static_cast<int>(reader.lengthInSamples);
+    sampleRate = reader.sampleRate;
+
+    audio.setSize(static_cast<int>(reader.numChannels), numSamples + paddingSamples);
+    audio.clear();
+
+    reader.read(&audio, 0, numSamples, 0, true, true);
+}
+
+SampleBuffer::SampleBuffer(const juce::AudioBuffer<float>& source, double sourceSampleRate)
+{
+    numSamples = source.getNumSamples();
+    sampleRate = sourceSampleRate;
+
+    audio.setSize(source.getNumChannels(), numSamples + paddingSamples);
+    audio.clear();
+
+    for(int channel = 0; channel < source.getNumChannels(); channel++)
+    {
+        audio.copyFrom(channel, 0, source, channel, 0, numSamples);
+    }
+}
+
+SampleBuffer::Ptr SampleBuffer::loadFromFile(juce::AudioFormatManager& formatManager, const juce::File& file)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if(reader == nullptr || reader->lengthInSamples <= 0)
+    {
+        DBG("Couldn't decode " << file.getFileName());
+        return nullptr;
+    }
+
+    return new SampleBuffer(*reader);
+}
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    SampleBuffer.h
+    Created: 5 Oct 2024 11:02:13am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//A decoded audio file held in memory, shared by every bank that plays it
+class SampleBuffer : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<SampleBuffer>;
+
+    SampleBuffer(juce::AudioFormatReader& reader);
+    SampleBuffer(const juce::AudioBuffer<float>& source, double sourceSampleRate); //copies audio that's already in memory
+
+    //decodes the whole file, returns nullptr if it can't be read
+    static Ptr loadFromFile(juce::AudioFormatManager& formatManager, const juce::File& file);
+
+    const float* getReadPointer(int channel) const
+    {
+        return audio.getReadPointer(channel);
+    }
+
+    int getNumChannels() const
+    {
+        return audio.getNumChannels();
+    }
+
+    //length of the file, the buffer itself is padded at the end for the interpolator
+    int getNumSamples() const
+    {
+        return numSamples;
+    }
+
+    double getSampleRate() const
+    {
+        return sampleRate;
+    }
+
+    double getLengthInSeconds() const
+    {
+        return sampleRate > 0 ? numSamples / sampleRate : 0.0;
+    }
+
+    //the whole buffer, padding included, only the first getNumSamples are the file
+    const juce::AudioBuffer<float>& getAudio() const
+    {
+        return audio;
+    }
+
+    //silent samples after the end so interpolating past the last sample never reads out of bounds
+    static constexpr int paddingSamples = 4;
+
+private:
+    juce::AudioBuffer<float> audio;
+    int numSamples = 0;
+    double sampleRate = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleBuffer)
+};
@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    SendEffects.cpp
+    Created: 14 Oct 2024 1:37:52pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "SendEffects.h"
+
+void SendEffects::prepare(double sampleRate, int maximumBlockSize, int numChannels)
+{
+    currentSampleRate = sampleRate;
+
+    delayLine.setSize(juce::jlimit(1, 2, numChannels), static_cast<int>(maxDelaySeconds * sampleRate) + 2);
+    delaySamples.reset(sampleRate, 0.1);
+    reverbBuffer.setSize(PartitionedConvolver::maxChannels, maximumBlockSize);
+
+    setReverbDecay(reverbDecay);
+    reset();
+}
+
+void SendEffects::reset()
+{
+    delayLine.clear();
+    delayWritePosition = 0;
+    dampingState.fill(0.0f);
+    delayTailRemaining = 0;
+
+    convolver.reset();
+    reverbTailRemaining = 0;
+}
+
+void SendEffects::setReverbDecay(float seconds)
+{
+    reverbDecay = seconds;
+    convolver.loadImpulseResponse(createImpulseResponse(seconds, currentSampleRate));
+}
+
+void SendEffects::setParameters(const Parameters& newParameters, double bpm)
+{
+    parameters = newParameters;
+
+    const float samples = static_cast<float>(parameters.delayBeats * 60.0 / juce::jmax(1.0, bpm) * currentSampleRate);
+    delaySamples.setTargetValue(juce::jlimit(1.0f, static_cast<float>(delayLine.getNumSamples() - 2), samples));
+}
+
+bool SendEffects::process(const SummingBus& bus, juce::AudioBuffer<float>& output, int numSamples)
+{
+    bool added = false;
+
+    //delay
+    const bool delayInput = bus.isSendActive(delaySend);
+
+    if(delayInput)
+    {
+        //repeats until the feedback has taken them below -60dB
+        const float repeats = parameters.feedback > 0.001f ? std::ceil(std::log(0.001f) / std::log(parameters.feedback)) : 1.0f;
+        delayTailRemaining = static_cast<int>(juce::jmin(repeats + 1.0f, 64.0f) * delaySamples.getTargetValue()) + numSamples;
+    }
+
+    if(parameters.delayReturn > 0.0f && delayTailRemaining > 0)
+    {
+        processDelay(bus.getSend(delaySend), delayInput, output, numSamples);
+        added = true;
+    }
+
+    if(delayTailRemaining > 0)
+    {
+        delayTailRemaining -= numSamples;
+
+        if(delayTailRemaining <= 0)
+        {
+            //what's left is under -60dB, cleared once so it doesn't come back with the next send
+            delayTailRemaining = 0;
+            delayLine.clear();
+            dampingState.fill(0.0f);
+        }
+    }
+
+    //reverb
+    const bool reverbInput = bus.isSendActive(reverbSend);
+
+    if(reverbInput)
+    {
+        reverbTailRemaining = convolver.getImpulseLength() + convolver.getLatencySamples() + numSamples;
+    }
+
+    const int maximumLength = reverbBuffer.getNumSamples();
+
+    if(parameters.reverbReturn > 0.0f && reverbTailRemaining > 0 && maximumLength > 0)
+    {
+        const auto& send = bus.getSend(reverbSend);
+
+        //blocks bigger than the one we prepared for are done in pieces rather than reallocating
+        for(int position = 0; position < numSamples; position += maximumLength)
+        {
+            const int length = juce::jmin(numSamples - position, maximumLength);
+
+            for(int channel = 0; channel < reverbBuffer.getNumChannels(); channel++)
+            {
+                if(reverbInput)
+                {
+                    reverbBuffer.copyFrom(channel, 0, send, juce::jmin(channel, send.getNumChannels() - 1), position, length);
+                }else
+                {
+                    reverbBuffer.clear(channel, 0, length); //the tail keeps ringing from the convolver's history
+                }
+            }
+
+            convolver.process(reverbBuffer, length);
+
+            if(output.getNumChannels() > 1)
+            {
+                output.addFrom(0, position, reverbBuffer, 0, 0, length, parameters.reverbReturn);
+                output.addFrom(1, position, reverbBuffer, 1, 0, length, parameters.reverbReturn);
+            }else
+            {
+                output.addFrom(0, position, reverbBuffer, 0, 0, length, parameters.reverbReturn * 0.5f);
+                output.addFrom(0, position, reverbBuffer, 1, 0, length, parameters.reverbReturn * 0.5f);
+            }
+        }
+
+        added = true;
+    }
+
+    reverbTailRemaining = juce::jmax(0, reverbTailRemaining - numSamples);
+
+    return added;
+}
+
+void SendEffects::processDelay(const juce::AudioBuffer<float>& input, bool inputActive, juce::AudioBuffer<float>& output, int numSamples)
+{
+    const int numChannels = juce::jmin(output.getNumChannels(), delayLine.getNumChannels());
+    const int size = delayLine.getNumSamples();
+    const float dampingCoefficient = 1.0f - 0.9f * parameters.damping;
+
+    for(int i = 0; i < numSamples; i++)
+    {
+        float readPosition = static_cast<float>(delayWritePosition) - delaySamples.getNextValue();
+        if(readPosition < 0.0f)
+        {
+            readPosition += static_cast<float>(size);
+        }
+
+        const int index = static_cast<int>(readPosition);
+        const float fraction = readPosition - static_cast<float>(index);
+        const int nextIndex = index + 1 < size ? index + 1 : 0;
+
+        for(int channel = 0; channel < numChannels; channel++)
+        {
+            float* line = delayLine.getWritePointer(channel);
+
+            const float delayed = line[index] + fraction * (line[nextIndex] - line[index]);
+            dampingState[channel] += (delayed - dampingState[channel]) * dampingCoefficient;
+
+            const float in = inputActive ? input.getSample(juce::jmin(channel, input.getNumChannels() - 1), i) : 0.0f;
+            line[delayWritePosition] = in + parameters.feedback * dampingState[channel];
+
+            output.addSample(channel, i, delayed * parameters.delayReturn);
+        }
+
+        delayWritePosition = delayWritePosition + 1 < size ? delayWritePosition + 1 : 0;
+    }
+}
+
+juce::AudioBuffer<float> SendEffects::createImpulseResponse(float decaySeconds, double sampleRate)
+{
+    const int length = juce::jmax(1, static_cast<int>(decaySeconds * sampleRate));
+    juce::AudioBuffer<float> impulse(2, length);
+
+    for(int channel = 0; channel < impulse.getNumChannels(); channel++)
+    {
+        juce::Random random(0x5eed + channel); //fixed seeds so a bounce sounds the same every time
+        float* data = impulse.getWritePointer(channel);
+        float lowpass = 0.0f;
+        double energy = 0.0;
+
+        for(int i = 0; i < length; i++)
+        {
+            const float position = static_cast<float>(i) / static_cast<float>(length);
+            const float envelope = std::exp(-6.9078f * position); //-60dB at the end
+            const float coefficient = 0.9f - 0.7f * position;
+
+            lowpass += (random.nextFloat() * 2.0f - 1.0f - lowpass) * coefficient;
+            data[i] = lowpass * envelope;
+            energy += data[i] * data[i];
+        }
+
+        //unit energy, so the return level is roughly the same whatever the decay
+        if(energy > 0.0)
+        {
+            impulse.applyGain(channel, 0, length, static_cast<float>(1.0 / std::sqrt(energy)));
+        }
+    }
+
+    return impulse;
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    SendEffects.h
+    Created: 14 Oct 2024 1:37:52pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SummingBus.h"
+#include "PartitionedConvolver.h"
+
+//The two shared send buses: a tempo synced delay and a convolution reverb. Banks feed them through the
+//summing bus at their own send level, and the returns are added to the main mix before the master gain.
+//Each effect stops processing once nothing has been sent for longer than its tail.
+class SendEffects
+{
+public:
+    //send indices on the summing bus
+    enum Send { delaySend, reverbSend };
+
+    static constexpr double maxDelaySeconds = 4.0;
+
+    struct Parameters
+    {
+        float delayBeats = 0.75f; //dotted eighth
+        float feedback = 0.35f; //0 - 0.95
+        float damping = 0.3f; //0 - 1, darkens each repeat
+        float delayReturn = 0.8f;
+        float reverbReturn = 0.8f;
+    };
+
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+    void reset();
+
+    //not the audio thread, generates a new impulse response and swaps it into the convolver
+    void setReverbDecay(float seconds);
+
+    //audio thread
+    void setParameters(const Parameters& newParameters, double bpm);
+    bool process(const SummingBus& bus, juce::AudioBuffer<float>& output, int numSamples); //returns true if anything was added
+
+private:
+    void processDelay(const juce::AudioBuffer<float>& input, bool inputActive, juce::AudioBuffer<float>& output, int numSamples);
+
+    //exponentially decaying noise that gets darker as it decays, a different seed per channel for width
+    static juce::AudioBuffer<float> createImpulseResponse(float decaySeconds, double sampleRate);
+
+    Parameters parameters;
+    double currentSampleRate = 44100.0;
+    std::atomic<float> reverbDecay {1.5f};
+
+    juce::AudioBuffer<float> delayLine;
+    int delayWritePosition = 0;
+    juce::SmoothedValue<float> delaySamples; //smoothed so changing the tempo or time doesn't click
+    std::array<float, 2> dampingState {};
+    int delayTailRemaining = 0;
+
+    PartitionedConvolver convolver;
+    juce::AudioBuffer<float> reverbBuffer;
+    int reverbTailRemaining = 0;
+};
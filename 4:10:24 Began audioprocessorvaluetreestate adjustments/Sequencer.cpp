@@ -11,8 +11,27 @@
 #include <JuceHeader.h>
 #include "Sequencer.h"
 
+//the step lock parameters in the order they appear in the lock box
+struct LockParameter
+{
+    const char* name;
+    StepLocks::Flags flag;
+    float StepLocks::* value;
+    double minimum, maximum, interval;
+};
+
+static const LockParameter lockParameters[] =
+{
+    { "Start", StepLocks::startOffsetLocked, &StepLocks::startOffset, 0.0, 1.0, 0.001 },
+    { "Pitch", StepLocks::pitchLocked, &StepLocks::pitch, -24.0, 24.0, 0.25 },
+    { "Pan", StepLocks::panLocked, &StepLocks::pan, -1.0, 1.0, 0.01 },
+    { "Gain", StepLocks::gainLocked, &StepLocks::gain, 0.0, 1.0, 0.01 },
+    { "Attack", StepLocks::attackLocked, &StepLocks::attack, 0.0, 2.55, 0.01 },
+    { "Release", StepLocks::releaseLocked, &StepLocks::release, 0.0, 5.1, 0.02 }
+};
+
 //==============================================================================
-Sequencer::Sequencer()
+Sequencer::Sequencer(SequencerEngine& engine, juce::UndoManager& undoManager) : engine(engine), undoManager(undoManager)
 {
     addAndMakeVisible(seqStart);
     seqStart.addListener(this);
@@ -33,7 +52,7 @@ Sequencer::Sequencer()
         speedButtonVector[i]->onClick = [this, i] //captures i by value
         {
             currentSpeedIndex = i;
-            speedChange = true;
+            this->engine.setStepsPerBeat(speedValues[currentSpeedIndex]);
         };
     }
             buttonHalf.setButtonText("1/2");
@@ -45,6 +64,19 @@ Sequencer::Sequencer()
     buttonSixteenth.setToggleState(true, juce::dontSendNotification);
     
             currentSpeedIndex = 3;
+            engine.setStepsPerBeat(speedValues[currentSpeedIndex]);
+    
+    addAndMakeVisible(bpmSlider);
+    bpmSlider.addListener(this);
+    bpmSlider.setRange(40.0, 240.0, 0.1);
+    bpmSlider.setValue(120.0, juce::dontSendNotification);
+    bpmSlider.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 50, 20);
+    bpmSlider.setNumDecimalPlacesToDisplay(1);
+    
+    addAndMakeVisible(bpmLabel);
+    bpmLabel.setText("BPM", juce::dontSendNotification);
+    
+    sequencePlaying = engine.isInternalTransportRunning();
     
     for(int i = 0; i < stepButtons.size(); i++)
     {
@@ -53,11 +85,74 @@ Sequencer::Sequencer()
         stepButtons[i]->setToggleable(true);
         stepButtons[i]->setColour(juce::TextButton::buttonColourId, juce::Colours::grey);
     }
+    
+    for(auto* button : {&pageDownButton, &pageUpButton, &patternDownButton, &patternUpButton, &addToChainButton, &clearChainButton})
+    {
+        addAndMakeVisible(button);
+        button->addListener(this);
+    }
+    
+    addAndMakeVisible(songModeButton);
+    songModeButton.setToggleState(engine.isSongMode(), juce::dontSendNotification);
+    songModeButton.onClick = [this]
+    {
+        this->engine.setSongMode(songModeButton.getToggleState());
+    };
+    
+    addAndMakeVisible(patternLabel);
+    patternLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(chainLabel);
+    
+    for(auto* slider : {&velocitySlider, &probabilitySlider, &microTimingSlider})
+    {
+        addAndMakeVisible(slider);
+        slider->addListener(this);
+        slider->setTextBoxStyle(juce::Slider::TextBoxLeft, false, 50, 20);
+    }
+    
+    velocitySlider.setRange(1.0, 127.0, 1.0);
+    velocitySlider.setTextValueSuffix(" vel");
+    probabilitySlider.setRange(0.0, 100.0, 1.0);
+    probabilitySlider.setTextValueSuffix("%");
+    microTimingSlider.setRange(-StepData::maxMicroTiming, StepData::maxMicroTiming, 1.0);
+    microTimingSlider.setTextValueSuffix(" tick");
+    
+    addAndMakeVisible(lockParameterBox);
+    for(int i = 0; i < std::size(lockParameters); i++)
+    {
+        lockParameterBox.addItem(lockParameters[i].name, i + 1);
+    }
+    lockParameterBox.setSelectedItemIndex(0, juce::dontSendNotification);
+    lockParameterBox.onChange = [this] { updateLockControls(); };
+    
+    addAndMakeVisible(lockButton);
+    lockButton.onClick = [this]
+    {
+        setSelectedLock(lockButton.getToggleState(), static_cast<float>(lockSlider.getValue()));
+    };
+    
+    addAndMakeVisible(lockSlider);
+    lockSlider.addListener(this);
+    lockSlider.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 50, 20);
+    
+    addAndMakeVisible(swingSlider);
+    swingSlider.addListener(this);
+    swingSlider.setRange(Pattern::minSwing, Pattern::maxSwing, 1.0);
+    swingSlider.setTextValueSuffix("% swing");
+    swingSlider.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 50, 20);
+    
+    refreshSteps();
+    updatePatternLabels();
+    updateStepDataSliders();
+    
+    startTimerHz(30); //playhead display
             
 }
 
 Sequencer::~Sequencer()
 {
+    stopTimer();
+    
     for(int i = 0; i < speedButtonVector.size(); i++)
     {
         speedButtonVector[i] = nullptr;
@@ -80,10 +175,12 @@ void Sequencer::paint (juce::Graphics& g)
     float spaceLeft = this->getWidth() - startingPoint;
     float increment = spaceLeft / 16;
 
-    for(int i = 0; i < 16; i++)
+    const bool showingPlayingPattern = playingPattern == engine.getSelectedPattern();
+    
+    for(int i = 0; i < stepsPerPage; i++)
     {
-        
-        g.setColour(i == currentStep ? juce::Colours::red : juce::Colours::grey);
+        const bool isCurrent = showingPlayingPattern && currentPage * stepsPerPage + i == currentStep;
+        g.setColour(isCurrent ? juce::Colours::red : juce::Colours::grey);
         g.fillEllipse(startingPoint + (increment * i), 0, 10, 10);
     }
 }
@@ -95,6 +192,9 @@ void Sequencer::resized()
     increaseStepsButton.setBounds(column,0,column,this->getHeight() / 4);
     decreaseStepsButton.setBounds(column,this->getHeight() / 4,column,this->getHeight() / 4);
     
+    bpmLabel.setBounds(0, this->getHeight() / 2, column / 3, this->getHeight() / 6);
+    bpmSlider.setBounds(column / 3, this->getHeight() / 2, column * 5 / 3, this->getHeight() / 6);
+    
     float radioButtonHeight = this->getHeight() / 6;
     
     buttonHalf.setBounds(column * 2, 0, column, radioButtonHeight);
@@ -103,6 +203,18 @@ void Sequencer::resized()
     buttonSixteenth.setBounds(column * 2, radioButtonHeight * 3, column, radioButtonHeight);
     buttonThirtySecond.setBounds(column * 2, radioButtonHeight * 4, column, radioButtonHeight);
     
+    //patterns and song chain
+    songModeButton.setBounds(0, radioButtonHeight * 4, column / 2, radioButtonHeight);
+    addToChainButton.setBounds(column / 2, radioButtonHeight * 4, column / 2, radioButtonHeight);
+    clearChainButton.setBounds(0, radioButtonHeight * 5, column / 2, radioButtonHeight);
+    chainLabel.setBounds(column / 2, radioButtonHeight * 5, column * 3 / 2, radioButtonHeight);
+    
+    patternDownButton.setBounds(column, radioButtonHeight * 3, column / 4, radioButtonHeight);
+    patternLabel.setBounds(column + column / 4, radioButtonHeight * 3, column / 2, radioButtonHeight);
+    patternUpButton.setBounds(column + column * 3 / 4, radioButtonHeight * 3, column / 4, radioButtonHeight);
+    pageDownButton.setBounds(column, radioButtonHeight * 4, column / 2, radioButtonHeight);
+    pageUpButton.setBounds(column + column / 2, radioButtonHeight * 4, column / 2, radioButtonHeight);
+    
     
     //for the sequencer
     float startingPoint = (column * 3) - column * 0.2;
@@ -113,47 +225,39 @@ void Sequencer::resized()
     {
         stepButtons[i]->setBounds(startingPoint + (increment * i), this->getHeight() / 2, increment / 2, this->getHeight() / 8);
     }
-
-}
-
-void Sequencer::updateTimerInterval()
-{
-    double quarterNoteDuratinMs = 60000.0 / bpm;
     
-    stepDurationMs = quarterNoteDuratinMs / speedValues[currentSpeedIndex];
+    float sliderWidth = spaceLeft / 3;
+    velocitySlider.setBounds(startingPoint, radioButtonHeight * 4, sliderWidth, radioButtonHeight);
+    probabilitySlider.setBounds(startingPoint + sliderWidth, radioButtonHeight * 4, sliderWidth, radioButtonHeight);
+    microTimingSlider.setBounds(startingPoint + sliderWidth * 2, radioButtonHeight * 4, sliderWidth, radioButtonHeight);
     
-    DBG(stepDurationMs);
+    lockParameterBox.setBounds(startingPoint, radioButtonHeight * 5, sliderWidth / 2, radioButtonHeight);
+    lockButton.setBounds(startingPoint + sliderWidth / 2, radioButtonHeight * 5, sliderWidth / 2, radioButtonHeight);
+    lockSlider.setBounds(startingPoint + sliderWidth, radioButtonHeight * 5, sliderWidth, radioButtonHeight);
+    swingSlider.setBounds(startingPoint + sliderWidth * 2, radioButtonHeight * 5, sliderWidth, radioButtonHeight);
+
 }
 
 void Sequencer::timerCallback()
 {
-    
-    if(currentStep < stepsPerSequence - 1)
+    if(engine.isFollowingHost())
     {
-        currentStep++;
+        bpmLabel.setText("Host " + juce::String(engine.getCurrentBpm(), 1), juce::dontSendNotification);
     }else
     {
-        currentStep = 0;
+        bpmLabel.setText("BPM", juce::dontSendNotification);
     }
     
-    if(speedChange == true)
-    {
-        start();
-        speedChange = false;
-    }
+    int step = engine.getCurrentStep();
+    int pattern = engine.getPlayingPattern();
     
-    //if current step is equal to number in sequence
-    //bank1 should trigger sample (using bankGUI playbutton as editor is middleman)
-    for(int i = 0; i < 5; i++)
+    if(step != currentStep || pattern != playingPattern)
     {
-        int bank = i;
-        if(sequence[bank][currentStep] == 1)
-        {
-            triggerSample(bank);
-        }
+        currentStep = step;
+        playingPattern = pattern;
+        updatePatternLabels();
+        repaint();
     }
-    
-    repaint();
 }
 
 void Sequencer::buttonClicked(juce::Button *button)
@@ -164,18 +268,19 @@ void Sequencer::buttonClicked(juce::Button *button)
         if(stepButtons[i] == button)
         {
             juce::TextButton * stepButton = stepButtons[i];
+            const int step = currentPage * stepsPerPage + i;
             
             if(currentBank < 6)
             {
-                if(sequence[currentBank - 1][i] == 1)
-                {
-                    stepButton->setColour(juce::TextButton::buttonColourId, juce::Colours::grey);
-                    sequence[currentBank - 1][i] = 0;
-                }else
-                {
-                    stepButton->setColour(juce::TextButton::buttonColourId, juce::Colours::green);
-                    sequence[currentBank - 1][i] = 1;
-                }
+                const bool isOn = !engine.getStep(currentBank - 1, step);
+                
+                stepButton->setColour(juce::TextButton::buttonColourId, isOn ? juce::Colours::green : juce::Colours::grey);
+                
+                undoManager.beginNewTransaction("Step");
+                undoManager.perform(new StepEdit(engine, engine.getSelectedPattern(), currentBank - 1, step, isOn));
+                
+                selectedStep = step;
+                updateStepDataSliders();
             }
             
         }
@@ -201,63 +306,167 @@ void Sequencer::buttonClicked(juce::Button *button)
     
     if(&increaseStepsButton == button)
     {
-        if(stepsPerSequence < 16)
-        {
-            stepsPerSequence++;
-            DBG("Steps : " << stepsPerSequence);
-        }
+        engine.setStepsPerSequence(engine.getStepsPerSequence() + 1);
+        DBG("Steps : " << engine.getStepsPerSequence());
+        refreshSteps();
     }
     
     if(&decreaseStepsButton == button)
     {
-        if(stepsPerSequence > 1)
-        {
-            stepsPerSequence--;
-            DBG("Steps : " << stepsPerSequence);
-        }
+        engine.setStepsPerSequence(engine.getStepsPerSequence() - 1);
+        DBG("Steps : " << engine.getStepsPerSequence());
+        refreshSteps();
+    }
+    
+    if(&pageDownButton == button || &pageUpButton == button)
+    {
+        const int numberOfPages = (engine.getStepsPerSequence() + stepsPerPage - 1) / stepsPerPage;
+        currentPage = juce::jlimit(0, numberOfPages - 1, currentPage + (&pageUpButton == button ? 1 : -1));
+        refreshSteps();
+        repaint();
+    }
+    
+    if(&patternDownButton == button || &patternUpButton == button)
+    {
+        engine.setSelectedPattern(engine.getSelectedPattern() + (&patternUpButton == button ? 1 : -1));
+        currentPage = 0;
+        refreshSteps();
+        updatePatternLabels();
+        updateStepDataSliders();
+        repaint();
+    }
+    
+    if(&addToChainButton == button)
+    {
+        engine.appendToChain(engine.getSelectedPattern());
+        updatePatternLabels();
+    }
+    
+    if(&clearChainButton == button)
+    {
+        engine.clearChain();
+        updatePatternLabels();
     }
 }
 
-void Sequencer::sliderValueChanged(juce::Slider *slider)
+void Sequencer::setBpm(double bpm)
 {
+    bpmSlider.setValue(bpm, juce::sendNotificationSync); //the slider listener passes it on to the engine
+}
 
+void Sequencer::sliderValueChanged(juce::Slider *slider)
+{
+    if(&bpmSlider == slider)
+    {
+        engine.setInternalBpm(bpmSlider.getValue());
+    }
+    
+    if((&velocitySlider == slider || &probabilitySlider == slider || &microTimingSlider == slider) && currentBank < 6)
+    {
+        StepData data;
+        data.velocity = static_cast<juce::uint8>(velocitySlider.getValue());
+        data.probability = static_cast<juce::uint8>(probabilitySlider.getValue());
+        data.microTiming = static_cast<juce::int8>(microTimingSlider.getValue());
+        engine.setStepData(currentBank - 1, selectedStep, data);
+    }
+    
+    if(&lockSlider == slider)
+    {
+        setSelectedLock(true, static_cast<float>(lockSlider.getValue())); //moving the value locks it
+    }
+    
+    if(&swingSlider == slider)
+    {
+        engine.setSwing(juce::roundToInt(swingSlider.getValue()));
+    }
 }
 
 void Sequencer::start()
 {
-    updateTimerInterval();
-    int d = static_cast<int>(stepDurationMs);
-    DBG(d);
-    startTimer(d);
+    engine.setInternalTransportRunning(true); //only used when there's no host transport
 }
 
 void Sequencer::stop()
 {
-    stopTimer();
+    engine.setInternalTransportRunning(false);
 }
 
-int Sequencer::calculateIntervalMs()
+void Sequencer::setCurrentBank(int bank) //1 - 5
 {
-    double quarterNoteDuration = 60000.0 / bpm;
-    
-    double stepDuration = quarterNoteDuration / speedValues[currentSpeedIndex];
-    
-    return stepDuration;
+    currentBank = bank;
+    refreshSteps();
+    updateStepDataSliders();
+    DBG(bank);
 }
 
-void Sequencer::setCurrentBank(int bank) //1 - 5
+void Sequencer::refreshSteps()
 {
-    currentBank = bank;
+    const int length = engine.getStepsPerSequence();
     
     for(int i = 0; i < stepButtons.size(); i++)
     {
+        const int step = currentPage * stepsPerPage + i;
+        
+        stepButtons[i]->setButtonText(juce::String(step + 1));
+        stepButtons[i]->setEnabled(step < length);
         stepButtons[i]->setColour(juce::TextButton::buttonColourId, juce::Colours::grey);
-        if(sequence[currentBank - 1][i] == 1)
+        if(currentBank < 6 && engine.getStep(currentBank - 1, step))
         {
             stepButtons[i]->setColour(juce::TextButton::buttonColourId, juce::Colours::green);
         }
     }
-    DBG(bank);
 }
 
+void Sequencer::updatePatternLabels()
+{
+    patternLabel.setText(juce::String(engine.getSelectedPattern() + 1), juce::dontSendNotification);
+    
+    juce::String chainText;
+    
+    for(int i = 0; i < engine.getChainLength(); i++)
+    {
+        const int entry = engine.getChainEntry(i) + 1;
+        chainText << (engine.isSongMode() && engine.getChainEntry(i) == playingPattern ? "[" + juce::String(entry) + "]" : juce::String(entry)) << " ";
+    }
+    
+    chainLabel.setText(chainText.trimEnd(), juce::dontSendNotification);
+}
 
+void Sequencer::updateStepDataSliders()
+{
+    const auto data = currentBank < 6 ? engine.getStepData(currentBank - 1, selectedStep) : StepData();
+    
+    velocitySlider.setValue(data.velocity, juce::dontSendNotification);
+    probabilitySlider.setValue(data.probability, juce::dontSendNotification);
+    microTimingSlider.setValue(data.microTiming, juce::dontSendNotification);
+    swingSlider.setValue(engine.getSwing(), juce::dontSendNotification);
+    
+    updateLockControls();
+}
+
+void Sequencer::updateLockControls()
+{
+    const auto& parameter = lockParameters[juce::jmax(0, lockParameterBox.getSelectedItemIndex())];
+    const auto locks = currentBank < 6 ? engine.getStepLocks(currentBank - 1, selectedStep) : StepLocks();
+    
+    lockSlider.setRange(parameter.minimum, parameter.maximum, parameter.interval);
+    lockSlider.setValue(locks.*parameter.value, juce::dontSendNotification);
+    lockButton.setToggleState(locks.isLocked(parameter.flag), juce::dontSendNotification);
+}
+
+void Sequencer::setSelectedLock(bool isLocked, float value)
+{
+    if(currentBank >= 6)
+    {
+        return;
+    }
+    
+    const auto& parameter = lockParameters[juce::jmax(0, lockParameterBox.getSelectedItemIndex())];
+    auto locks = engine.getStepLocks(currentBank - 1, selectedStep);
+    
+    locks.*parameter.value = value;
+    locks.flags = isLocked ? (locks.flags | parameter.flag) : (locks.flags & ~static_cast<juce::uint32>(parameter.flag));
+    
+    engine.setStepLocks(currentBank - 1, selectedStep, locks);
+    lockButton.setToggleState(isLocked, juce::dontSendNotification);
+}
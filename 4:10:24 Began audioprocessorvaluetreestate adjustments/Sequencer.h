@@ -11,6 +11,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "SequencerEngine.h"
+#include "UndoableEdits.h"
 
 //==============================================================================
 /*
@@ -18,24 +20,28 @@
 class Sequencer  : public juce::Component, public juce::Timer,  public juce::Button::Listener, public juce::Slider::Listener
 {
 public:
-    Sequencer();
+    Sequencer(SequencerEngine& engine, juce::UndoManager& undoManager); //step toggles are undoable
     ~Sequencer() override;
 
     void paint (juce::Graphics&) override;
     void resized() override;
     void buttonClicked(juce::Button *button) override;
     void sliderValueChanged(juce::Slider * slider) override;
-    void updateTimerInterval();
-    void timerCallback() override;
+    void timerCallback() override; //only repaints the current step, the engine runs on the audio thread
     void setCurrentBank(int bank);
+    void refreshSteps(); //step buttons for the current bank, page and pattern
 
     void start();
     
     void stop();
     
-    std::function<void(int bank)>triggerSample;
+    void setBpm(double bpm); //tempo for when there's no host, e.g. the detected tempo of a new sample
+    
 private:
     
+    SequencerEngine& engine;
+    juce::UndoManager& undoManager;
+    
     juce::TextButton seqStart{"Start"};
     juce::TextButton increaseStepsButton{"+1 steps"};
     juce::TextButton decreaseStepsButton{"-1 steps"};
@@ -44,6 +50,8 @@ private:
     std::vector<int> stepValues = {4, 8, 16, 32, 64};
     
     juce::Slider speedSlider;
+    juce::Slider bpmSlider; //tempo when there's no host
+    juce::Label bpmLabel;
     std::vector<double> speedValues = {0.5, 1.0, 2.0, 4.0, 8.0, 16.0};
     int currentSpeedIndex;
     
@@ -54,23 +62,42 @@ private:
    
     std::vector<juce::TextButton*>stepButtons = {&step1, &step2, &step3, &step4, &step5, &step6, &step7, &step8, &step9, &step10, &step11, &step12, &step13, &step14, &step15, &step16};
     
-    std::vector<std::vector<int>> sequence = {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-        {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-        {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-        {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-        {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}};
+    //paging, 16 step buttons show one page of a pattern up to 256 steps long
+    juce::TextButton pageDownButton{"<"};
+    juce::TextButton pageUpButton{">"};
+    int currentPage = 0;
+    static constexpr int stepsPerPage = 16;
+    
+    //pattern bank and song chain
+    juce::TextButton patternDownButton{"<"};
+    juce::TextButton patternUpButton{">"};
+    juce::Label patternLabel;
+    juce::ToggleButton songModeButton{"Song"};
+    juce::TextButton addToChainButton{"+ Chain"};
+    juce::TextButton clearChainButton{"Clear"};
+    juce::Label chainLabel;
+    
+    //velocity, probability and micro-timing of the last clicked step
+    juce::Slider velocitySlider, probabilitySlider, microTimingSlider;
+    int selectedStep = 0;
+    
+    //parameter locks on the selected step, one parameter is edited at a time
+    juce::ComboBox lockParameterBox;
+    juce::ToggleButton lockButton{"Lock"};
+    juce::Slider lockSlider;
+    juce::Slider swingSlider;
+    
+    void updatePatternLabels();
+    void updateStepDataSliders();
+    void updateLockControls();
+    void setSelectedLock(bool isLocked, float value);
     
-    int bpm = 120;
-    int stepsPerSequence = 16;
-    double stepDurationMs;
     int currentStep = 0;
-    bool speedChange = false;
+    int playingPattern = 0;
     
-    bool sequencePlaying = true;
+    bool sequencePlaying = false;
     
     int currentBank = 6;
     
-    int calculateIntervalMs();
-    void processStep(int step);
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Sequencer)
 };
@@ -0,0 +1,406 @@
+/*
+  ==============================================================================
+
+    SequencerEngine.cpp
+    Created: 5 Oct 2024 3:41:50pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "SequencerEngine.h"
+
+SequencerEngine::SequencerEngine()
+{
+    for(auto& entry : chain)
+    {
+        entry = 0;
+    }
+
+    lastStepFired.fill(-1);
+}
+
+void SequencerEngine::prepareToPlay(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+}
+
+void SequencerEngine::processBlock(juce::AudioPlayHead* playHead, int numSamples, std::vector<BankEvent>& events)
+{
+    double ppqStart = 0.0;
+    double bpm = 0.0;
+    bool running = false;
+    bool hostPositionValid = false;
+
+    if(playHead != nullptr)
+    {
+        if(auto position = playHead->getPosition())
+        {
+            auto ppq = position->getPpqPosition();
+            auto hostBpm = position->getBpm();
+
+            if(ppq.hasValue() && hostBpm.hasValue())
+            {
+                hostPositionValid = true;
+                ppqStart = *ppq;
+                bpm = *hostBpm; //read every block so tempo ramps are followed
+                running = position->getIsPlaying();
+            }
+        }
+    }
+
+    if(!hostPositionValid) //standalone, or a host that doesn't give a position
+    {
+        bpm = internalBpm;
+        running = internalRunning;
+
+        if(running && !wasInternalRunning)
+        {
+            internalPpq = 0.0;
+            lastStepEnd = 0.0;
+            lastStepFired.fill(-1);
+        }
+
+        wasInternalRunning = running;
+        ppqStart = internalPpq;
+    }
+
+    followingHost = hostPositionValid;
+    currentBpm = bpm;
+
+    if(!running || bpm <= 0.0 || numSamples <= 0)
+    {
+        return;
+    }
+
+    const double ppqPerSample = bpm / (60.0 * sampleRate);
+    const double ppqEnd = ppqStart + numSamples * ppqPerSample;
+
+    if(!hostPositionValid)
+    {
+        internalPpq = ppqEnd;
+    }
+
+    const double beatsToSteps = stepsPerBeat;
+    const double samplesPerStep = 1.0 / (ppqPerSample * beatsToSteps);
+    const double stepStart = ppqStart * beatsToSteps;
+    const double stepEnd = ppqEnd * beatsToSteps;
+
+    //micro-timing moves a step up to half a step either way and swing up to another half step late,
+    //so look that far past both ends of the block
+    const double maxShift = static_cast<double>(StepData::maxMicroTiming) / StepData::ticksPerStep + 0.5;
+    const auto firstStep = static_cast<juce::int64>(std::ceil(stepStart - maxShift));
+
+    if(stepStart < lastStepEnd - 0.5) //host looped or jumped backwards
+    {
+        lastStepFired.fill(firstStep - 1);
+    }
+
+    lastStepEnd = stepEnd;
+
+    //held for the whole block, if a new map is being swapped in right now this block plays the selected pattern
+    const juce::SpinLock::ScopedTryLockType mapLock(songMapLock);
+    const SongMap* map = mapLock.isLocked() && songMode ? songMap.get() : nullptr;
+
+    for(auto step = firstStep; step < stepEnd + maxShift; step++)
+    {
+        if(step < 0)
+        {
+            continue;
+        }
+
+        int patternIndex = 0;
+        int stepInPattern = 0;
+        locateStep(step, map, patternIndex, stepInPattern);
+
+        if(step >= stepStart && step < stepEnd)
+        {
+            currentStep = stepInPattern;
+            playingPattern = patternIndex;
+        }
+
+        const auto& pattern = patterns[patternIndex];
+        const juce::uint32 triggerMask = pattern.getTriggerMask(stepInPattern); //every bank for this step in one load
+
+        if(triggerMask == 0)
+        {
+            continue;
+        }
+
+        const double swingOffset = (stepInPattern % 2) == 1 ? pattern.getSwingOffset() : 0.0;
+
+        for(int bank = 0; bank < numberOfBanks; bank++)
+        {
+            if((triggerMask & (1u << bank)) == 0 || step <= lastStepFired[bank])
+            {
+                continue;
+            }
+
+            const auto data = pattern.getStepData(bank, stepInPattern);
+            const double triggerStep = step + swingOffset + static_cast<double>(data.microTiming) / StepData::ticksPerStep;
+
+            if(triggerStep >= stepEnd) //pushed late into the next block
+            {
+                continue;
+            }
+
+            lastStepFired[bank] = step;
+
+            if(triggerStep < stepStart)
+            {
+                continue;
+            }
+
+            if(data.probability < 100 && random.nextInt(100) >= data.probability)
+            {
+                continue;
+            }
+
+            if(events.size() < events.capacity()) //never grows on the audio thread
+            {
+                BankEvent event;
+                event.samplePosition = juce::jlimit(0, numSamples - 1, static_cast<int>((triggerStep - stepStart) * samplesPerStep));
+                event.bankIndex = bank;
+                event.type = BankEvent::Type::noteOn;
+                event.velocity = data.velocity / 127.0f;
+                event.locks = pattern.getStepLocks(bank, stepInPattern);
+                events.push_back(event);
+            }
+        }
+    }
+}
+
+void SequencerEngine::locateStep(juce::int64 step, const SongMap* map, int& patternIndex, int& stepInPattern) const
+{
+    if(map != nullptr && !map->steps.empty())
+    {
+        const auto entry = map->steps[static_cast<size_t>(step % static_cast<juce::int64>(map->steps.size()))];
+        patternIndex = entry >> 8;
+        stepInPattern = entry & 0xff;
+        return;
+    }
+
+    //not in song mode, or the chain is empty
+    patternIndex = selectedPattern;
+    stepInPattern = static_cast<int>(step % patterns[patternIndex].getLength());
+}
+
+void SequencerEngine::setStep(int bank, int step, bool isOn)
+{
+    patterns[selectedPattern].setStep(bank, step, isOn);
+}
+
+bool SequencerEngine::getStep(int bank, int step) const
+{
+    return patterns[selectedPattern].getStep(bank, step);
+}
+
+void SequencerEngine::setStepData(int bank, int step, StepData data)
+{
+    patterns[selectedPattern].setStepData(bank, step, data);
+}
+
+StepData SequencerEngine::getStepData(int bank, int step) const
+{
+    return patterns[selectedPattern].getStepData(bank, step);
+}
+
+void SequencerEngine::setStepLocks(int bank, int step, const StepLocks& locks)
+{
+    patterns[selectedPattern].setStepLocks(bank, step, locks);
+}
+
+StepLocks SequencerEngine::getStepLocks(int bank, int step) const
+{
+    return patterns[selectedPattern].getStepLocks(bank, step);
+}
+
+void SequencerEngine::setSwing(int percent)
+{
+    patterns[selectedPattern].setSwing(percent);
+}
+
+int SequencerEngine::getSwing() const
+{
+    return patterns[selectedPattern].getSwing();
+}
+
+void SequencerEngine::setStepsPerSequence(int steps)
+{
+    patterns[selectedPattern].setLength(steps);
+    rebuildSongMap();
+}
+
+int SequencerEngine::getStepsPerSequence() const
+{
+    return patterns[selectedPattern].getLength();
+}
+
+void SequencerEngine::setSelectedPattern(int patternIndex)
+{
+    selectedPattern = juce::jlimit(0, numberOfPatterns - 1, patternIndex);
+}
+
+int SequencerEngine::getSelectedPattern() const
+{
+    return selectedPattern;
+}
+
+Pattern& SequencerEngine::getPattern(int patternIndex)
+{
+    return patterns[static_cast<size_t>(juce::jlimit(0, numberOfPatterns - 1, patternIndex))];
+}
+
+void SequencerEngine::appendToChain(int patternIndex)
+{
+    const int entries = chainLength;
+
+    if(entries < maxChainLength)
+    {
+        chain[entries] = juce::jlimit(0, numberOfPatterns - 1, patternIndex);
+        chainLength = entries + 1; //published after the entry so the GUI never reads an unset slot
+        rebuildSongMap();
+    }
+}
+
+void SequencerEngine::clearChain()
+{
+    chainLength = 0;
+    rebuildSongMap();
+}
+
+void SequencerEngine::rebuildSongMap()
+{
+    SongMap::Ptr newMap = new SongMap();
+    const int entries = chainLength;
+
+    for(int i = 0; i < entries; i++)
+    {
+        const int index = chain[i];
+        const int length = patterns[index].getLength();
+
+        for(int step = 0; step < length; step++)
+        {
+            newMap->steps.push_back(static_cast<juce::uint16>((index << 8) | step));
+        }
+    }
+
+    SongMap::Ptr released;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(songMapLock);
+        released = songMap;
+        songMap = newMap;
+    }
+    //the old map is freed here, after the lock is let go
+}
+
+int SequencerEngine::getChainLength() const
+{
+    return chainLength;
+}
+
+int SequencerEngine::getChainEntry(int position) const
+{
+    if(juce::isPositiveAndBelow(position, getChainLength()))
+    {
+        return chain[position];
+    }
+
+    return 0;
+}
+
+void SequencerEngine::setSongMode(bool shouldPlayChain)
+{
+    songMode = shouldPlayChain;
+}
+
+bool SequencerEngine::isSongMode() const
+{
+    return songMode;
+}
+
+void SequencerEngine::setStepsPerBeat(double steps)
+{
+    stepsPerBeat = steps;
+}
+
+double SequencerEngine::getStepsPerBeat() const
+{
+    return stepsPerBeat;
+}
+
+int SequencerEngine::getSongLengthInSteps() const
+{
+    if(songMode)
+    {
+        const juce::SpinLock::ScopedLockType lock(songMapLock);
+
+        if(songMap != nullptr && !songMap->steps.empty())
+        {
+            return static_cast<int>(songMap->steps.size());
+        }
+    }
+
+    return patterns[selectedPattern].getLength();
+}
+
+void SequencerEngine::copyFrom(const SequencerEngine& other)
+{
+    for(int i = 0; i < numberOfPatterns; i++)
+    {
+        patterns[i].copyFrom(other.patterns[i]);
+    }
+
+    for(int i = 0; i < maxChainLength; i++)
+    {
+        chain[i] = other.chain[i].load();
+    }
+
+    chainLength = other.getChainLength();
+    songMode = other.isSongMode();
+    selectedPattern = other.getSelectedPattern();
+    stepsPerBeat = other.getStepsPerBeat();
+    internalBpm = other.getCurrentBpm(); //the host's tempo if it was following one
+    rebuildSongMap();
+}
+
+void SequencerEngine::setInternalBpm(double bpm)
+{
+    internalBpm = bpm;
+}
+
+double SequencerEngine::getInternalBpm() const
+{
+    return internalBpm;
+}
+
+void SequencerEngine::setInternalTransportRunning(bool shouldRun)
+{
+    internalRunning = shouldRun;
+}
+
+bool SequencerEngine::isInternalTransportRunning() const
+{
+    return internalRunning;
+}
+
+int SequencerEngine::getCurrentStep() const
+{
+    return currentStep;
+}
+
+int SequencerEngine::getPlayingPattern() const
+{
+    return playingPattern;
+}
+
+double SequencerEngine::getCurrentBpm() const
+{
+    return currentBpm;
+}
+
+bool SequencerEngine::isFollowingHost() const
+{
+    return followingHost;
+}
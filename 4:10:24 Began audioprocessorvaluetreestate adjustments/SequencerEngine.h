@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    SequencerEngine.h
+    Created: 5 Oct 2024 3:41:50pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Bank.h"
+#include "Pattern.h"
+
+//Audio thread side of the sequencer, the Sequencer component only edits and displays it.
+//Steps are worked out from the host's PPQ position every block so they stay locked to the DAW,
+//when there's no host position (standalone) it runs from its own sample clock instead.
+//Holds a bank of patterns, either the selected one loops or the song chain plays them in order.
+class SequencerEngine
+{
+public:
+    SequencerEngine();
+
+    static constexpr int numberOfBanks = Pattern::numberOfBanks;
+    static constexpr int maxSteps = Pattern::maxSteps;
+    static constexpr int numberOfPatterns = 16;
+    static constexpr int maxChainLength = 64;
+
+    void prepareToPlay(double sampleRate);
+
+    //adds a note on for every step that starts inside this block, at its sample offset after swing and micro-timing
+    void processBlock(juce::AudioPlayHead* playHead, int numSamples, std::vector<BankEvent>& events);
+
+    //message thread, steps are edited on the selected pattern
+    void setStep(int bank, int step, bool isOn);
+    bool getStep(int bank, int step) const;
+
+    void setStepData(int bank, int step, StepData data);
+    StepData getStepData(int bank, int step) const;
+
+    void setStepLocks(int bank, int step, const StepLocks& locks);
+    StepLocks getStepLocks(int bank, int step) const;
+
+    void setSwing(int percent);
+    int getSwing() const;
+
+    void setStepsPerSequence(int steps);
+    int getStepsPerSequence() const;
+
+    void setSelectedPattern(int patternIndex);
+    int getSelectedPattern() const;
+    Pattern& getPattern(int patternIndex);
+
+    //song chain, a list of pattern indices played one after the other
+    void appendToChain(int patternIndex);
+    void clearChain();
+    int getChainLength() const;
+    int getChainEntry(int position) const;
+    void setSongMode(bool shouldPlayChain);
+    bool isSongMode() const;
+
+    void setStepsPerBeat(double steps); //4 = 1/16 notes
+    double getStepsPerBeat() const;
+    void setInternalBpm(double bpm);
+    double getInternalBpm() const; //what the sequencer plays at with no host tempo, a copy's tempo before it has run
+
+    //steps in the chain when in song mode, otherwise the selected pattern
+    int getSongLengthInSteps() const;
+
+    //patterns, chain and timing settings, used to give the offline renderer its own copy
+    void copyFrom(const SequencerEngine& other);
+
+    void setInternalTransportRunning(bool shouldRun);
+    bool isInternalTransportRunning() const;
+
+    //for the GUI
+    int getCurrentStep() const;
+    int getPlayingPattern() const;
+    double getCurrentBpm() const;
+    bool isFollowingHost() const;
+
+private:
+
+    //every step of the song chain mapped to its pattern and the step in that pattern, rebuilt on the
+    //message thread whenever the chain or a pattern's length changes so the audio thread only indexes it
+    struct SongMap : public juce::ReferenceCountedObject
+    {
+        using Ptr = juce::ReferenceCountedObjectPtr<SongMap>;
+
+        std::vector<juce::uint16> steps; //pattern index in the high byte, step in the low byte
+        static_assert(maxSteps <= 256 && numberOfPatterns <= 256, "a song step is packed into 16 bits");
+    };
+
+    void rebuildSongMap();
+
+    //finds which pattern and which of its steps a running step count lands on, map is null outside song mode
+    void locateStep(juce::int64 step, const SongMap* map, int& patternIndex, int& stepInPattern) const;
+
+    std::array<Pattern, numberOfPatterns> patterns;
+    std::atomic<int> selectedPattern {0};
+
+    std::array<std::atomic<int>, maxChainLength> chain;
+    std::atomic<int> chainLength {0};
+    std::atomic<bool> songMode {false};
+    SongMap::Ptr songMap;
+    juce::SpinLock songMapLock; //the audio thread holds it for a block, a swap only takes it to change the pointer
+
+    std::atomic<double> stepsPerBeat {4.0};
+    std::atomic<double> internalBpm {120.0};
+    std::atomic<bool> internalRunning {false};
+
+    std::atomic<int> currentStep {0};
+    std::atomic<int> playingPattern {0};
+    std::atomic<double> currentBpm {120.0};
+    std::atomic<bool> followingHost {false};
+
+    //audio thread only
+    double sampleRate = 44100.0;
+    double internalPpq = 0.0; //position of the internal clock in quarter notes
+    bool wasInternalRunning = false;
+    double lastStepEnd = 0.0;
+    std::array<juce::int64, numberOfBanks> lastStepFired; //stops a step firing twice when the host position jitters over a boundary
+    juce::Random random; //for step probability
+};
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    SliceVariants.cpp
+    Created: 16 Oct 2024 5:48:20pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "SliceVariants.h"
+
+SliceVariants::SliceVariants(std::vector<Variant> newVariants, Policy newPolicy)
+    : variants(std::move(newVariants)), policy(newPolicy)
+{
+    if(variants.size() > maxVariants)
+    {
+        variants.resize(maxVariants);
+    }
+
+    //group the variants by layer, keeping the order they were added in so round robins go round in that order
+    std::array<Candidates, numberOfLayers> layers {};
+    int position = 0;
+
+    for(int layer = 0; layer < numberOfLayers; layer++)
+    {
+        layers[static_cast<size_t>(layer)].layer = static_cast<juce::uint8>(layer);
+        layers[static_cast<size_t>(layer)].first = static_cast<juce::uint8>(position);
+
+        for(size_t i = 0; i < variants.size(); i++)
+        {
+            if(juce::jlimit(0, numberOfLayers - 1, variants[i].layer) == layer)
+            {
+                order[static_cast<size_t>(position++)] = static_cast<juce::uint8>(i);
+            }
+        }
+
+        layers[static_cast<size_t>(layer)].count = static_cast<juce::uint8>(position - layers[static_cast<size_t>(layer)].first);
+    }
+
+    for(int velocity = 0; velocity < 128; velocity++)
+    {
+        const int layer = velocity * numberOfLayers / 128;
+
+        //nearest layer with something in it, the softer one on a tie
+        for(int distance = 0; distance < numberOfLayers; distance++)
+        {
+            if(layer - distance >= 0 && layers[static_cast<size_t>(layer - distance)].count > 0)
+            {
+                velocityTable[static_cast<size_t>(velocity)] = layers[static_cast<size_t>(layer - distance)];
+                break;
+            }
+
+            if(layer + distance < numberOfLayers && layers[static_cast<size_t>(layer + distance)].count > 0)
+            {
+                velocityTable[static_cast<size_t>(velocity)] = layers[static_cast<size_t>(layer + distance)];
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    SliceVariants.h
+    Created: 16 Oct 2024 5:48:20pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Interval.h"
+
+//Extra slices a bank plays instead of its loop region, for drum chops with velocity layers and round robins.
+//They're only regions of the bank's sample, so every variant reads the one decoded buffer.
+//Built on the message thread and swapped into the bank whole, the tables are worked out here so picking a
+//variant on the audio thread is a lookup by velocity and a counter or random number within the layer.
+class SliceVariants : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<SliceVariants>;
+
+    enum class Policy { roundRobin, random };
+
+    struct Variant
+    {
+        Interval<float> region; //0-1 of the file, like Bank::loopRegion
+        int layer = 0; //0 is the softest
+    };
+
+    static constexpr int maxVariants = 32;
+    static constexpr int numberOfLayers = 4; //split the velocity range evenly
+
+    //variants past maxVariants are dropped, a velocity whose layer is empty uses the nearest layer that isn't
+    SliceVariants(std::vector<Variant> variants, Policy policy);
+
+    const std::vector<Variant>& getVariants() const
+    {
+        return variants;
+    }
+
+    Policy getPolicy() const
+    {
+        return policy;
+    }
+
+    //the variants a velocity can pick from, order[first] to order[first + count - 1]
+    struct Candidates
+    {
+        juce::uint8 layer = 0;
+        juce::uint8 first = 0;
+        juce::uint8 count = 0;
+    };
+
+    const Candidates& getCandidates(float velocity) const
+    {
+        return velocityTable[static_cast<size_t>(juce::jlimit(0, 127, juce::roundToInt(velocity * 127.0f)))];
+    }
+
+    const Interval<float>& getRegion(const Candidates& candidates, int choice) const
+    {
+        return variants[order[static_cast<size_t>(candidates.first + choice)]].region;
+    }
+
+private:
+    std::vector<Variant> variants;
+    Policy policy;
+
+    std::array<juce::uint8, maxVariants> order {}; //variant indices grouped by layer
+    std::array<Candidates, 128> velocityTable {};
+};
@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    SliceVariantsTests.cpp
+    Created: 18 Oct 2024 2:31:07pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SliceVariants.h"
+#include "Bank.h"
+
+class SliceVariantsTests : public juce::UnitTest
+{
+public:
+    SliceVariantsTests() : juce::UnitTest("Slice variants", "Bank") {}
+
+    void runTest() override
+    {
+        //the nth variant covers the nth 64th of the file, so a region says which variant it came from
+        auto variant = [](int index, int layer)
+        {
+            SliceVariants::Variant v;
+            v.region.start(index / 64.0f);
+            v.region.end((index + 1) / 64.0f);
+            v.layer = layer;
+            return v;
+        };
+
+        auto variantIndex = [](const Interval<float>& region)
+        {
+            return juce::roundToInt(region.start() * 64.0f);
+        };
+
+        auto velocity = [](int midiVelocity)
+        {
+            return static_cast<float>(midiVelocity) / 127.0f;
+        };
+
+        beginTest("Velocities split evenly over the layers");
+        {
+            SliceVariants variants({variant(0, 0), variant(1, 1), variant(2, 2), variant(3, 3)}, SliceVariants::Policy::roundRobin);
+
+            const std::vector<std::pair<int, int>> velocityToLayer {{1, 0}, {31, 0}, {32, 1}, {63, 1}, {64, 2}, {95, 2}, {96, 3}, {127, 3}};
+
+            for(const auto& [midiVelocity, layer] : velocityToLayer)
+            {
+                const auto& candidates = variants.getCandidates(velocity(midiVelocity));
+                expectEquals(static_cast<int>(candidates.layer), layer, "velocity " + juce::String(midiVelocity));
+                expectEquals(static_cast<int>(candidates.count), 1);
+                expectEquals(variantIndex(variants.getRegion(candidates, 0)), layer);
+            }
+
+            //out of range velocities are held to the ends of the table
+            expectEquals(static_cast<int>(variants.getCandidates(-1.0f).layer), 0);
+            expectEquals(static_cast<int>(variants.getCandidates(2.0f).layer), 3);
+        }
+
+        beginTest("An empty layer uses the nearest one, the softer on a tie");
+        {
+            SliceVariants outer({variant(0, 0), variant(1, 3)}, SliceVariants::Policy::roundRobin);
+            expectEquals(static_cast<int>(outer.getCandidates(velocity(40)).layer), 0);
+            expectEquals(static_cast<int>(outer.getCandidates(velocity(80)).layer), 3);
+
+            SliceVariants middle({variant(0, 1), variant(1, 2)}, SliceVariants::Policy::roundRobin);
+            expectEquals(static_cast<int>(middle.getCandidates(velocity(10)).layer), 1);
+            expectEquals(static_cast<int>(middle.getCandidates(velocity(120)).layer), 2);
+
+            SliceVariants single({variant(5, 2)}, SliceVariants::Policy::roundRobin);
+
+            for(int midiVelocity = 0; midiVelocity < 128; midiVelocity++)
+            {
+                const auto& candidates = single.getCandidates(velocity(midiVelocity));
+                expectEquals(static_cast<int>(candidates.count), 1);
+                expectEquals(variantIndex(single.getRegion(candidates, 0)), 5);
+            }
+
+            SliceVariants none({}, SliceVariants::Policy::roundRobin);
+            expectEquals(static_cast<int>(none.getCandidates(1.0f).count), 0, "no variants means the loop region");
+        }
+
+        beginTest("A layer's variants keep the order they were added in");
+        {
+            SliceVariants variants({variant(0, 3), variant(1, 0), variant(2, 3), variant(3, 7), variant(4, -2)}, SliceVariants::Policy::roundRobin);
+
+            //layers outside the range are held to the loudest and softest
+            const auto& loud = variants.getCandidates(1.0f);
+            expectEquals(static_cast<int>(loud.count), 3);
+            expectEquals(variantIndex(variants.getRegion(loud, 0)), 0);
+            expectEquals(variantIndex(variants.getRegion(loud, 1)), 2);
+            expectEquals(variantIndex(variants.getRegion(loud, 2)), 3);
+
+            const auto& soft = variants.getCandidates(velocity(1));
+            expectEquals(static_cast<int>(soft.count), 2);
+            expectEquals(variantIndex(variants.getRegion(soft, 0)), 1);
+            expectEquals(variantIndex(variants.getRegion(soft, 1)), 4);
+        }
+
+        beginTest("Variants past maxVariants are dropped");
+        {
+            std::vector<SliceVariants::Variant> many;
+
+            for(int i = 0; i < SliceVariants::maxVariants + 8; i++)
+            {
+                many.push_back(variant(i, i % SliceVariants::numberOfLayers));
+            }
+
+            SliceVariants variants(many, SliceVariants::Policy::random);
+            expectEquals(static_cast<int>(variants.getVariants().size()), SliceVariants::maxVariants);
+
+            int total = 0;
+
+            for(int layer = 0; layer < SliceVariants::numberOfLayers; layer++)
+            {
+                const auto& candidates = variants.getCandidates(velocity(layer * 32 + 16));
+                total += candidates.count;
+
+                for(int choice = 0; choice < candidates.count; choice++)
+                {
+                    expectLessThan(variantIndex(variants.getRegion(candidates, choice)), SliceVariants::maxVariants);
+                }
+            }
+
+            expectEquals(total, SliceVariants::maxVariants);
+        }
+
+        beginTest("A bank plays each layer's variants round robin");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int blockSize = 1024;
+            constexpr int slotLength = 2 * blockSize; //every note is still inside its region at the end of a block
+
+            //the left channel is constant and the right is the left times the variant's index, so the ratio
+            //of the two says which variant a note played whatever the envelope and velocity did to it
+            juce::AudioBuffer<float> source(2, 64 * slotLength);
+
+            for(int i = 0; i < source.getNumSamples(); i++)
+            {
+                source.setSample(0, i, 0.01f);
+                source.setSample(1, i, 0.01f * static_cast<float>(i / slotLength));
+            }
+
+            juce::AudioFormatManager formatManager;
+            Bank bank(formatManager);
+            bank.setSample(new SampleBuffer(source, sampleRate));
+            bank.prepareToPlay(blockSize, sampleRate);
+            bank.setSliceVariants(new SliceVariants({variant(10, 3), variant(20, 0), variant(11, 3), variant(12, 3)}, SliceVariants::Policy::roundRobin));
+
+            juce::AudioBuffer<float> output(2, blockSize);
+
+            auto playNote = [&](float noteVelocity)
+            {
+                output.clear();
+                bank.noteOn(noteVelocity);
+                bank.renderNextBlock(output, 0, blockSize);
+
+                //late enough in the block for the last note's declick to be over
+                const int at = blockSize - 1;
+                return output.getSample(0, at) > 0.0f ? juce::roundToInt(output.getSample(1, at) / output.getSample(0, at)) : -1;
+            };
+
+            expectEquals(playNote(1.0f), 10);
+            expectEquals(playNote(1.0f), 11);
+            expectEquals(playNote(velocity(5)), 20);
+            expectEquals(playNote(1.0f), 12, "the soft note doesn't move the loud layer on");
+            expectEquals(playNote(1.0f), 10, "and round again");
+            expectEquals(playNote(velocity(5)), 20);
+
+            bank.setSliceVariants(nullptr);
+            bank.setLoopRegion(30.0f / 64.0f, 31.0f / 64.0f);
+            expectEquals(playNote(1.0f), 30, "without variants the loop region plays");
+        }
+    }
+};
+
+static SliceVariantsTests sliceVariantsTests;
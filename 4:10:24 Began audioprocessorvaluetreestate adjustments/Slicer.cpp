@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    Slicer.cpp
+    Created: 9 Oct 2024 5:37:12pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "Slicer.h"
+
+std::vector<Slice> Slicer::fromTransients(const std::vector<float>& transientTimes, double sampleRate,
+                                          juce::int64 lengthInSamples, juce::int64 minimumSliceLength)
+{
+    std::vector<Slice> slices;
+
+    if(lengthInSamples <= 0)
+    {
+        return slices;
+    }
+
+    juce::int64 sliceStart = 0;
+
+    for(auto time : transientTimes)
+    {
+        const auto cut = static_cast<juce::int64>(time * sampleRate);
+
+        if(cut <= sliceStart || cut >= lengthInSamples || cut - sliceStart < minimumSliceLength)
+        {
+            continue;
+        }
+
+        slices.push_back({sliceStart, cut});
+        sliceStart = cut;
+    }
+
+    slices.push_back({sliceStart, lengthInSamples}); //the last slice runs to the end of the file
+    return slices;
+}
+
+std::vector<GridSlice> Slicer::fromBeatGrid(const BeatGrid& grid, double sampleRate, juce::int64 lengthInSamples,
+                                           int divisionsPerBeat)
+{
+    std::vector<GridSlice> slices;
+
+    if(!grid.isValid() || sampleRate <= 0 || lengthInSamples <= 0 || divisionsPerBeat <= 0)
+    {
+        return slices;
+    }
+
+    const double divisionLength = grid.getBeatLength() / divisionsPerBeat * sampleRate; //in samples, not whole
+    const double firstCut = grid.firstBeat * sampleRate;
+
+    for(juce::int64 division = 0;; division++)
+    {
+        //each cut is rounded on its own so the error never builds up along the file
+        const auto start = static_cast<juce::int64>(std::round(firstCut + division * divisionLength));
+        const auto end = static_cast<juce::int64>(std::round(firstCut + (division + 1) * divisionLength));
+
+        if(end > lengthInSamples)
+        {
+            break;
+        }
+
+        //rounding makes slices a sample longer or shorter than each other, the speed takes up the difference.
+        //a division lasts 60 / (bpm * divisionsPerBeat) seconds, so speed = sliceSeconds * bpm * divisionsPerBeat / 60
+        GridSlice gridSlice;
+        gridSlice.slice = {start, end};
+        gridSlice.speedPerBpm = (end - start) / sampleRate * divisionsPerBeat / 60.0;
+        slices.push_back(gridSlice);
+    }
+
+    return slices;
+}
+
+bool Slicer::writeSlice(juce::AudioFormatReader& reader, const Slice& slice, const juce::File& file,
+                        int bitsPerSample, juce::AudioBuffer<float>& scratch)
+{
+    file.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+
+    if(stream->failedToOpen())
+    {
+        return false;
+    }
+
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), reader.sampleRate,
+                                                                              static_cast<unsigned int>(scratch.getNumChannels()),
+                                                                              bitsPerSample, {}, 0));
+
+    if(writer == nullptr)
+    {
+        return false;
+    }
+
+    stream.release(); //the writer owns the stream now
+
+    const int chunkSize = scratch.getNumSamples();
+
+    for(juce::int64 position = slice.start; position < slice.end; position += chunkSize)
+    {
+        const int numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(chunkSize), slice.end - position));
+
+        if(!reader.read(&scratch, 0, numSamples, position, true, true)
+           || !writer->writeFromAudioSampleBuffer(scratch, 0, numSamples))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+juce::var Slicer::toJSON(const std::vector<Slice>& slices, double sampleRate, const juce::StringArray& fileNames)
+{
+    juce::Array<juce::var> sliceList;
+
+    for(int i = 0; i < slices.size(); i++)
+    {
+        auto* sliceObject = new juce::DynamicObject();
+        sliceObject->setProperty("file", i < fileNames.size() ? fileNames[i] : juce::String());
+        sliceObject->setProperty("start", slices[i].start);
+        sliceObject->setProperty("end", slices[i].end);
+        sliceObject->setProperty("startSeconds", slices[i].start / sampleRate);
+        sliceObject->setProperty("lengthSeconds", slices[i].length() / sampleRate);
+        sliceList.add(juce::var(sliceObject));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("sampleRate", sampleRate);
+    root->setProperty("slices", sliceList);
+    return juce::var(root);
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    Slicer.h
+    Created: 9 Oct 2024 5:37:12pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BeatGrid.h"
+
+//one chop of a file, in samples
+struct Slice
+{
+    juce::int64 start = 0;
+    juce::int64 end = 0;
+
+    juce::int64 length() const
+    {
+        return end - start;
+    }
+};
+
+//a slice cut along a beat grid, with the speed that makes it last exactly its division at another tempo
+struct GridSlice
+{
+    Slice slice;
+    double speedPerBpm = 0.0; //playback speed is this times the tempo, worked out once when the slice is cut
+
+    double getSpeed(double bpm) const
+    {
+        return speedPerBpm * bpm;
+    }
+};
+
+//Turns transients into slices and writes them out, shared by the plugin and the batch chopper
+class Slicer
+{
+public:
+    //a slice between each pair of transients, from the start of the file to the end.
+    //transients closer than minimumSliceLength to the last cut are ignored
+    static std::vector<Slice> fromTransients(const std::vector<float>& transientTimes, double sampleRate,
+                                             juce::int64 lengthInSamples, juce::int64 minimumSliceLength = 0);
+
+    //equal slices of 1 / divisionsPerBeat of a beat from the grid's first beat, so 1 for quarter notes, 2 for eighths
+    //and 4 for sixteenths. Only whole divisions inside the file are kept
+    static std::vector<GridSlice> fromBeatGrid(const BeatGrid& grid, double sampleRate, juce::int64 lengthInSamples,
+                                               int divisionsPerBeat);
+
+    //copies a slice from the reader into a WAV file through the scratch buffer, so memory use
+    //stays at the scratch buffer's size however long the slice is
+    static bool writeSlice(juce::AudioFormatReader& reader, const Slice& slice, const juce::File& file,
+                           int bitsPerSample, juce::AudioBuffer<float>& scratch);
+
+    //{ "sampleRate": 44100, "slices": [ { "file": "...", "start": 0, "end": 1234 }, ... ] }
+    static juce::var toJSON(const std::vector<Slice>& slices, double sampleRate, const juce::StringArray& fileNames);
+};
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    StepLocksTests.cpp
+    Created: 18 Oct 2024 12:04:51pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Pattern.h"
+
+class StepLocksTests : public juce::UnitTest
+{
+public:
+    StepLocksTests() : juce::UnitTest("Step locks", "Sequencer") {}
+
+    void runTest() override
+    {
+        beginTest("Locks round trip to within their step size");
+        {
+            auto random = getRandom();
+            bool allWithin = true;
+
+            for(int i = 0; i < 1000; i++)
+            {
+                StepLocks locks;
+                locks.flags = static_cast<juce::uint32>(random.nextInt(64));
+                locks.startOffset = random.nextFloat();
+                locks.pitch = random.nextFloat() * 48.0f - 24.0f;
+                locks.pan = random.nextFloat() * 2.0f - 1.0f;
+                locks.gain = random.nextFloat();
+                locks.attack = random.nextFloat() * 2.55f;
+                locks.release = random.nextFloat() * 5.1f;
+
+                const auto unpacked = StepLocks::unpack(locks.pack());
+
+                //half a step of each field's resolution, see StepLocks
+                allWithin &= unpacked.flags == locks.flags;
+                allWithin &= std::abs(unpacked.startOffset - locks.startOffset) <= 0.5f / 1023.0f + 1.0e-6f;
+                allWithin &= std::abs(unpacked.pitch - locks.pitch) <= 0.125f + 1.0e-6f;
+                allWithin &= std::abs(unpacked.pan - locks.pan) <= 0.5f / 127.0f + 1.0e-6f;
+                allWithin &= std::abs(unpacked.gain - locks.gain) <= 0.5f / 255.0f + 1.0e-6f;
+                allWithin &= std::abs(unpacked.attack - locks.attack) <= 0.005f + 1.0e-6f;
+                allWithin &= std::abs(unpacked.release - locks.release) <= 0.01f + 1.0e-6f;
+            }
+
+            expect(allWithin);
+        }
+
+        beginTest("Values on the grid come back exactly");
+        {
+            StepLocks locks;
+            locks.flags = StepLocks::pitchLocked | StepLocks::releaseLocked;
+            locks.startOffset = 0.0f;
+            locks.pitch = -24.0f;
+            locks.pan = -1.0f;
+            locks.gain = 1.0f;
+            locks.attack = 2.55f;
+            locks.release = 5.1f;
+
+            const auto unpacked = StepLocks::unpack(locks.pack());
+            expect(unpacked.isLocked(StepLocks::pitchLocked) && unpacked.isLocked(StepLocks::releaseLocked));
+            expect(!unpacked.isLocked(StepLocks::gainLocked));
+            expectEquals(unpacked.startOffset, 0.0f);
+            expectEquals(unpacked.pitch, -24.0f);
+            expectEquals(unpacked.pan, -1.0f);
+            expectEquals(unpacked.gain, 1.0f);
+            expectWithinAbsoluteError(unpacked.attack, 2.55f, 1.0e-6f);
+            expectWithinAbsoluteError(unpacked.release, 5.1f, 1.0e-6f);
+        }
+
+        beginTest("Out of range values are clamped rather than wrapped");
+        {
+            StepLocks locks;
+            locks.startOffset = 1.5f;
+            locks.pitch = 30.0f;
+            locks.pan = -2.0f;
+            locks.gain = 2.0f;
+            locks.attack = 10.0f;
+            locks.release = -1.0f;
+
+            const auto unpacked = StepLocks::unpack(locks.pack());
+            expectEquals(unpacked.startOffset, 1.0f);
+            expectEquals(unpacked.pitch, 24.0f);
+            expectEquals(unpacked.pan, -1.0f);
+            expectEquals(unpacked.gain, 1.0f);
+            expectWithinAbsoluteError(unpacked.attack, 2.55f, 1.0e-6f);
+            expectEquals(unpacked.release, 0.0f);
+        }
+
+        beginTest("Step data round trips and a pattern clamps it");
+        {
+            bool allMatch = true;
+
+            for(int velocity = 0; velocity <= 127; velocity += 7)
+            {
+                for(int microTiming = -StepData::maxMicroTiming; microTiming <= StepData::maxMicroTiming; microTiming++)
+                {
+                    StepData data;
+                    data.velocity = static_cast<juce::uint8>(velocity);
+                    data.probability = static_cast<juce::uint8>(velocity % 101);
+                    data.microTiming = static_cast<juce::int8>(microTiming);
+
+                    const auto unpacked = StepData::unpack(data.pack());
+                    allMatch &= unpacked.velocity == data.velocity && unpacked.probability == data.probability && unpacked.microTiming == data.microTiming;
+                }
+            }
+
+            expect(allMatch);
+
+            auto pattern = std::make_unique<Pattern>();
+            StepData data;
+            data.velocity = 200;
+            data.probability = 150;
+            data.microTiming = -100;
+            pattern->setStepData(1, 3, data);
+
+            const auto stored = pattern->getStepData(1, 3);
+            expectEquals(static_cast<int>(stored.velocity), 127);
+            expectEquals(static_cast<int>(stored.probability), 100);
+            expectEquals(static_cast<int>(stored.microTiming), -StepData::maxMicroTiming);
+        }
+
+        beginTest("A pattern keeps each bank's locks on its own step");
+        {
+            auto pattern = std::make_unique<Pattern>();
+            StepLocks locks;
+            locks.flags = StepLocks::panLocked;
+            locks.pan = 0.5f;
+            pattern->setStepLocks(4, 200, locks);
+
+            expect(pattern->getStepLocks(4, 200).isLocked(StepLocks::panLocked));
+            expectWithinAbsoluteError(pattern->getStepLocks(4, 200).pan, 0.5f, 0.5f / 127.0f);
+            expectEquals(pattern->getStepLocks(3, 200).flags, 0u);
+            expectEquals(pattern->getStepLocks(4, 199).flags, 0u);
+        }
+    }
+};
+
+static StepLocksTests stepLocksTests;
@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    SummingBus.cpp
+    Created: 12 Oct 2024 11:48:09am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "SummingBus.h"
+
+void SummingBus::prepare(int numChannels, int maximumBlockSize)
+{
+    for(auto& stem : stems)
+    {
+        stem.setSize(numChannels, maximumBlockSize);
+        stem.clear();
+    }
+
+    for(auto& send : sends)
+    {
+        send.setSize(numChannels, maximumBlockSize);
+        send.clear();
+    }
+
+    stemInUse.fill(false);
+    sendActive.fill(false);
+}
+
+void SummingBus::release()
+{
+    for(auto& stem : stems)
+    {
+        stem.setSize(0, 0);
+    }
+
+    for(auto& send : sends)
+    {
+        send.setSize(0, 0);
+    }
+
+    sendActive.fill(false);
+
+    stemInUse.fill(false);
+}
+
+void SummingBus::setRoutedToStem(int bankIndex, bool shouldUseStem)
+{
+    if(juce::isPositiveAndBelow(bankIndex, maxBanks))
+    {
+        routedToStem[bankIndex] = shouldUseStem;
+    }
+}
+
+bool SummingBus::isRoutedToStem(int bankIndex) const
+{
+    return juce::isPositiveAndBelow(bankIndex, maxBanks) && routedToStem[bankIndex].load();
+}
+
+void SummingBus::setSendLevel(int bankIndex, int send, float level)
+{
+    if(juce::isPositiveAndBelow(bankIndex, maxBanks) && juce::isPositiveAndBelow(send, numberOfSends))
+    {
+        sendLevels[bankIndex][send] = level;
+    }
+}
+
+void SummingBus::beginBlock(int numSamples)
+{
+    blockNumSamples = numSamples;
+    busOutputs.fill(nullptr);
+
+    for(int i = 0; i < maxBanks; i++)
+    {
+        //a host going over the prepared block size just loses the stem for that block, it never reallocates here
+        bool sending = false;
+        for(int send = 0; send < numberOfSends; send++)
+        {
+            sending |= sendLevels[i][send] > 0.0f || lastSendLevels[i][send] > 0.0f; //still ramping down counts
+        }
+
+        stemInUse[i] = (routedToStem[i].load(std::memory_order_relaxed) || sending) && numSamples <= stems[i].getNumSamples();
+
+        if(stemInUse[i])
+        {
+            stems[i].clear(0, numSamples);
+        }
+    }
+
+    for(int send = 0; send < numberOfSends; send++)
+    {
+        sendActive[send] = false;
+
+        if(numSamples <= sends[send].getNumSamples())
+        {
+            sends[send].clear(0, numSamples);
+        }
+    }
+}
+
+void SummingBus::setBusOutput(int bankIndex, juce::AudioBuffer<float>* busOutput)
+{
+    if(juce::isPositiveAndBelow(bankIndex, maxBanks))
+    {
+        busOutputs[bankIndex] = busOutput;
+        stemInUse[bankIndex] = false; //the bus replaces the stem, so endBlock doesn't add it to the mix
+    }
+}
+
+juce::AudioBuffer<float>& SummingBus::getBankOutput(int bankIndex, juce::AudioBuffer<float>& mainOutput)
+{
+    if(busOutputs[bankIndex] != nullptr)
+    {
+        return *busOutputs[bankIndex];
+    }
+
+    return stemInUse[bankIndex] ? stems[bankIndex] : mainOutput;
+}
+
+void SummingBus::endBlock(juce::AudioBuffer<float>& mainOutput)
+{
+    for(int i = 0; i < maxBanks; i++)
+    {
+        const juce::AudioBuffer<float>* source = busOutputs[i] != nullptr ? busOutputs[i] : (stemInUse[i] ? &stems[i] : nullptr);
+
+        if(stemInUse[i])
+        {
+            const int numChannels = juce::jmin(mainOutput.getNumChannels(), stems[i].getNumChannels());
+
+            for(int channel = 0; channel < numChannels; channel++)
+            {
+                mainOutput.addFrom(channel, 0, stems[i], channel, 0, blockNumSamples);
+            }
+        }
+
+        for(int send = 0; send < numberOfSends; send++)
+        {
+            const float level = sendLevels[i][send];
+            const float lastLevel = lastSendLevels[i][send];
+            lastSendLevels[i][send] = level;
+
+            if(source == nullptr || (level <= 0.0f && lastLevel <= 0.0f) || blockNumSamples > sends[send].getNumSamples())
+            {
+                continue;
+            }
+
+            const int numChannels = juce::jmin(sends[send].getNumChannels(), source->getNumChannels());
+
+            for(int channel = 0; channel < numChannels; channel++)
+            {
+                sends[send].addFromWithRamp(channel, 0, source->getReadPointer(channel), blockNumSamples, lastLevel, level);
+            }
+
+            sendActive[send] = true;
+        }
+    }
+}
+
+const juce::AudioBuffer<float>& SummingBus::getStem(int bankIndex) const
+{
+    return stems[bankIndex];
+}
+
+const juce::AudioBuffer<float>& SummingBus::getSend(int send) const
+{
+    return sends[send];
+}
+
+bool SummingBus::isSendActive(int send) const
+{
+    return juce::isPositiveAndBelow(send, numberOfSends) && sendActive[send];
+}
+
+bool SummingBus::isUsingStemThisBlock(int bankIndex) const
+{
+    return juce::isPositiveAndBelow(bankIndex, maxBanks) && stemInUse[bankIndex];
+}
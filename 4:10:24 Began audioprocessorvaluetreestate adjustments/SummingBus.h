@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    SummingBus.h
+    Created: 12 Oct 2024 11:48:09am
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//The processor's mix stage. Banks add their voices straight into the output buffer, or into
+//their own stem buffer when they're routed to one, and the stems are summed in at the end of the block.
+//A bank can also be given a host output bus for the block, it then renders straight into that and skips the mix.
+//Banks with a send level get a stem so their signal can be added to the shared send buses as well.
+//Stem buffers are allocated in prepare so the audio thread never allocates.
+class SummingBus
+{
+public:
+    static constexpr int maxBanks = 6;
+    static constexpr int numberOfSends = 2;
+
+    void prepare(int numChannels, int maximumBlockSize);
+    void release();
+
+    //any thread, picked up at the start of the next block
+    void setRoutedToStem(int bankIndex, bool shouldUseStem);
+    bool isRoutedToStem(int bankIndex) const;
+
+    //audio thread, before beginBlock, ramped over the block from the last level
+    void setSendLevel(int bankIndex, int send, float level);
+
+    //audio thread
+    void beginBlock(int numSamples); //clears the stems in use this block and forgets last block's bus outputs
+    void setBusOutput(int bankIndex, juce::AudioBuffer<float>* busOutput); //after beginBlock, takes priority over the stem
+    juce::AudioBuffer<float>& getBankOutput(int bankIndex, juce::AudioBuffer<float>& mainOutput);
+    void endBlock(juce::AudioBuffer<float>& mainOutput); //adds the stems into the main output
+
+    //a bank's stem for the current block, empty unless it's routed to one
+    const juce::AudioBuffer<float>& getStem(int bankIndex) const;
+    bool isUsingStemThisBlock(int bankIndex) const;
+
+    //what every bank sent this block, valid after endBlock
+    const juce::AudioBuffer<float>& getSend(int send) const;
+    bool isSendActive(int send) const; //false when nothing was sent, so the send's effect can idle
+
+private:
+    std::array<juce::AudioBuffer<float>, maxBanks> stems;
+    std::array<std::atomic<bool>, maxBanks> routedToStem {};
+
+    //audio thread only
+    std::array<bool, maxBanks> stemInUse {};
+    std::array<juce::AudioBuffer<float>*, maxBanks> busOutputs {};
+    std::array<juce::AudioBuffer<float>, numberOfSends> sends;
+    std::array<std::array<float, numberOfSends>, maxBanks> sendLevels {};
+    std::array<std::array<float, numberOfSends>, maxBanks> lastSendLevels {};
+    std::array<bool, numberOfSends> sendActive {};
+    int blockNumSamples = 0;
+};
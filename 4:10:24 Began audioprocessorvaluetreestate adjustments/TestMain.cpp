@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    TestMain.cpp
+    Created: 18 Oct 2024 11:02:37am
+    Author:  Jake
+
+    Unit tests, built by SampleChopperTests.jucer.
+
+    SampleChopperTests [--category=<name>] [--seed=<n>]
+
+    Runs every juce::UnitTest in the *Tests.cpp files, or only those in one category, and
+    exits with 1 if anything failed so it can gate a build.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; //the processor tests need a message manager
+    juce::ArgumentList args(argc, argv);
+
+    //the seed is printed by the runner, so a failure with random input can be run again with --seed
+    const juce::int64 seed = args.containsOption("--seed") ? args.getValueForOption("--seed").getLargeIntValue()
+                                                           : juce::Random::getSystemRandom().nextInt64();
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+
+    if(args.containsOption("--category"))
+    {
+        runner.runTestsInCategory(args.getValueForOption("--category"), seed);
+    }else
+    {
+        runner.runAllTests(seed);
+    }
+
+    int failures = 0;
+
+    for(int i = 0; i < runner.getNumResults(); i++)
+    {
+        failures += runner.getResult(i)->failures;
+    }
+
+    std::cout << (failures == 0 ? "All tests passed" : juce::String(failures) + " failures") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    TransientDetector.cpp
+    Created: 9 Oct 2024 4:51:26pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "TransientDetector.h"
+
+TransientDetector::TransientDetector(double rate, const Settings& detectorSettings)
+    : sampleRate(rate), settings(detectorSettings)
+{
+    windowSize = juce::jmax(1, static_cast<int>(sampleRate / juce::jmax(1, settings.windowSizeDivisor)));
+}
+
+void TransientDetector::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int numChannels = buffer.getNumChannels();
+    int position = startSample;
+    const int end = startSample + numSamples;
+
+    while(position < end)
+    {
+        const int samplesThisWindow = juce::jmin(windowSize - samplesInWindow, end - position);
+
+        for(int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* data = buffer.getReadPointer(channel, position);
+
+            for(int i = 0; i < samplesThisWindow; i++)
+            {
+                windowEnergy += data[i] * data[i];
+            }
+        }
+
+        samplesInWindow += samplesThisWindow;
+        position += samplesThisWindow;
+
+        if(samplesInWindow == windowSize) //window finished, compare it with the last one
+        {
+            if(windowIndex > 0 && windowEnergy - previousWindowEnergy > settings.sensitivity)
+            {
+                transients.push_back(static_cast<float>(static_cast<double>(windowIndex) * windowSize / sampleRate));
+            }
+
+            previousWindowEnergy = windowEnergy;
+            windowEnergy = 0.0f;
+            samplesInWindow = 0;
+            windowIndex++;
+        }
+    }
+}
+
+std::vector<float> TransientDetector::detect(juce::AudioFormatReader& reader, const Settings& settings, int chunkSize)
+{
+    TransientDetector detector(reader.sampleRate, settings);
+    juce::AudioBuffer<float> chunk(static_cast<int>(reader.numChannels), chunkSize);
+
+    for(juce::int64 position = 0; position < reader.lengthInSamples; position += chunkSize)
+    {
+        const int numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(chunkSize), reader.lengthInSamples - position));
+        reader.read(&chunk, 0, numSamples, position, true, true);
+        detector.process(chunk, 0, numSamples);
+    }
+
+    return detector.getTransients();
+}
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    TransientDetector.h
+    Created: 9 Oct 2024 4:51:26pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//Energy based onset detection, moved out of WaveformDisplay so the batch chopper can use it without a GUI.
+//The file is split into windows of sampleRate / windowSizeDivisor samples and a transient is marked
+//wherever a window's energy jumps over the last one by more than the sensitivity.
+//Audio can be fed in any size chunks, so a file never has to be decoded all at once.
+class TransientDetector
+{
+public:
+    struct Settings
+    {
+        float sensitivity = 10.0f;
+        int windowSizeDivisor = 20; //20 = 50ms windows
+    };
+
+    TransientDetector(double sampleRate, const Settings& settings);
+
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    //transient times in seconds
+    const std::vector<float>& getTransients() const
+    {
+        return transients;
+    }
+
+    //reads the file through in chunks of chunkSize samples
+    static std::vector<float> detect(juce::AudioFormatReader& reader, const Settings& settings, int chunkSize = 65536);
+
+private:
+    double sampleRate;
+    Settings settings;
+    int windowSize;
+
+    int samplesInWindow = 0;
+    int windowIndex = 0;
+    float windowEnergy = 0.0f;
+    float previousWindowEnergy = 0.0f;
+
+    std::vector<float> transients;
+};
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    TransientDetectorTests.cpp
+    Created: 18 Oct 2024 12:41:09pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TransientDetector.h"
+
+class TransientDetectorTests : public juce::UnitTest
+{
+public:
+    TransientDetectorTests() : juce::UnitTest("Transient detector", "Slicing") {}
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 44100.0;
+        const TransientDetector::Settings settings; //50ms windows at 44.1kHz are 2205 samples
+        const int windowSize = static_cast<int>(sampleRate) / settings.windowSizeDivisor;
+
+        //two seconds of silence with decaying 100ms noise bursts, like drum hits, starting on windows 5, 16 and 26
+        const std::vector<int> burstWindows {5, 16, 26};
+        juce::AudioBuffer<float> audio(2, static_cast<int>(sampleRate * 2.0));
+        audio.clear();
+        auto random = getRandom();
+
+        for(auto window : burstWindows)
+        {
+            for(int i = 0; i < windowSize * 2; i++)
+            {
+                for(int channel = 0; channel < 2; channel++)
+                {
+                    const float envelope = 0.8f * std::exp(-3.0f * static_cast<float>(i) / static_cast<float>(windowSize));
+                    audio.setSample(channel, window * windowSize + i, envelope * (random.nextFloat() * 2.0f - 1.0f));
+                }
+            }
+        }
+
+        beginTest("Finds the start of each burst");
+        TransientDetector whole(sampleRate, settings);
+        whole.process(audio, 0, audio.getNumSamples());
+
+        const auto& transients = whole.getTransients();
+        expectEquals(static_cast<int>(transients.size()), static_cast<int>(burstWindows.size()));
+
+        for(size_t i = 0; i < juce::jmin(transients.size(), burstWindows.size()); i++)
+        {
+            expectWithinAbsoluteError(transients[i], static_cast<float>(burstWindows[i] * windowSize / sampleRate), 1.0e-5f);
+        }
+
+        beginTest("Chunks of any size give the same transients as the whole buffer");
+        for(int chunkSize : {1, 64, 1000, windowSize, windowSize + 1, 65536})
+        {
+            TransientDetector chunked(sampleRate, settings);
+
+            for(int position = 0; position < audio.getNumSamples(); position += chunkSize)
+            {
+                chunked.process(audio, position, juce::jmin(chunkSize, audio.getNumSamples() - position));
+            }
+
+            expect(chunked.getTransients() == transients, "chunks of " + juce::String(chunkSize));
+        }
+
+        beginTest("Reading a file through in chunks matches the whole buffer");
+        {
+            juce::MemoryBlock file;
+            juce::WavAudioFormat wavFormat;
+
+            {
+                auto stream = std::make_unique<juce::MemoryOutputStream>(file, false);
+                std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), sampleRate, 2, 32, {}, 0)); //32 bit float, so nothing is rounded
+                expect(writer != nullptr);
+
+                if(writer != nullptr)
+                {
+                    stream.release(); //the writer owns the stream now
+                    writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+                }
+            }
+
+            std::unique_ptr<juce::AudioFormatReader> reader(wavFormat.createReaderFor(new juce::MemoryInputStream(file, false), true));
+            expect(reader != nullptr);
+
+            if(reader != nullptr)
+            {
+                expect(TransientDetector::detect(*reader, settings, 3000) == transients);
+            }
+        }
+    }
+};
+
+static TransientDetectorTests transientDetectorTests;
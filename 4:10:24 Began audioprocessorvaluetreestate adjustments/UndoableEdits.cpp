@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    UndoableEdits.cpp
+    Created: 16 Oct 2024 2:31:08pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#include "UndoableEdits.h"
+#include "PluginProcessor.h"
+
+LoopRegionEdit::LoopRegionEdit(SampleChopperAudioProcessor& processorToUse, int bank, const Region& regionBefore, const Region& regionAfter)
+    : processor(processorToUse), bankIndex(bank), before(regionBefore), after(regionAfter)
+{
+}
+
+bool LoopRegionEdit::perform()
+{
+    apply(after);
+    return true;
+}
+
+bool LoopRegionEdit::undo()
+{
+    apply(before);
+    return true;
+}
+
+juce::UndoableAction* LoopRegionEdit::createCoalescedAction(juce::UndoableAction* nextAction)
+{
+    auto* next = dynamic_cast<LoopRegionEdit*>(nextAction);
+
+    if(next == nullptr || &next->processor != &processor || next->bankIndex != bankIndex)
+    {
+        return nullptr;
+    }
+
+    return new LoopRegionEdit(processor, bankIndex, before, next->after);
+}
+
+void LoopRegionEdit::apply(const Region& region)
+{
+    processor.getBank(bankIndex + 1)->setLoopRegion(region.interval.start(), region.interval.end());
+    processor.setBankTempoSync(bankIndex, region.speedPerBpm);
+}
+
+StepEdit::StepEdit(SequencerEngine& engineToUse, int pattern, int bankIndex, int stepIndex, bool shouldBeOn)
+    : engine(engineToUse),
+      patternIndex(static_cast<juce::uint8>(pattern)),
+      bank(static_cast<juce::uint8>(bankIndex)),
+      step(static_cast<juce::uint8>(stepIndex)),
+      isOn(shouldBeOn)
+{
+}
+
+bool StepEdit::perform()
+{
+    engine.getPattern(patternIndex).setStep(bank, step, isOn);
+    return true;
+}
+
+bool StepEdit::undo()
+{
+    engine.getPattern(patternIndex).setStep(bank, step, !isOn);
+    return true;
+}
+
+ParameterEdit::ParameterEdit(juce::AudioProcessorParameter& parameterToUse, float valueBefore, float valueAfter)
+    : parameter(parameterToUse), before(valueBefore), after(valueAfter)
+{
+}
+
+bool ParameterEdit::perform()
+{
+    parameter.setValueNotifyingHost(after); //no gesture, so the recorder doesn't see undo and redo as new edits
+    return true;
+}
+
+bool ParameterEdit::undo()
+{
+    parameter.setValueNotifyingHost(before);
+    return true;
+}
+
+ParameterGestureRecorder::ParameterGestureRecorder(juce::AudioProcessor& processorToUse, juce::UndoManager& undoManagerToUse)
+    : processor(processorToUse), undoManager(undoManagerToUse)
+{
+    const auto& parameters = processor.getParameters();
+    gestureStartValues.resize(static_cast<size_t>(parameters.size()), 0.0f);
+
+    for(auto* parameter : parameters)
+    {
+        parameter->addListener(this);
+    }
+}
+
+ParameterGestureRecorder::~ParameterGestureRecorder()
+{
+    for(auto* parameter : processor.getParameters())
+    {
+        parameter->removeListener(this);
+    }
+}
+
+void ParameterGestureRecorder::parameterValueChanged(int, float)
+{
+    //any thread, including the host's automation, nothing is recorded from here
+}
+
+void ParameterGestureRecorder::parameterGestureChanged(int parameterIndex, bool gestureIsStarting)
+{
+    auto* parameter = processor.getParameters()[parameterIndex];
+
+    if(parameter == nullptr || !juce::isPositiveAndBelow(parameterIndex, static_cast<int>(gestureStartValues.size()))
+       || !juce::MessageManager::existsAndIsCurrentThread())
+    {
+        return;
+    }
+
+    auto& startValue = gestureStartValues[static_cast<size_t>(parameterIndex)];
+
+    if(gestureIsStarting)
+    {
+        startValue = parameter->getValue();
+        return;
+    }
+
+    const float endValue = parameter->getValue();
+
+    if(endValue != startValue)
+    {
+        undoManager.beginNewTransaction(parameter->getName(64));
+        undoManager.perform(new ParameterEdit(*parameter, startValue, endValue));
+        undoManager.beginNewTransaction();
+    }
+}
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    UndoableEdits.h
+    Created: 16 Oct 2024 2:31:08pm
+    Author:  Jake
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Interval.h"
+#include "SequencerEngine.h"
+
+class SampleChopperAudioProcessor;
+
+//Loop regions and sequencer steps live in the banks and the engine rather than the ValueTree, so their edits go
+//into the processor's UndoManager as these. Each one only holds what changed, before and after, so a long
+//session's history stays small and the UndoManager's unit limit keeps it bounded.
+//Parameters are recorded the same way, one edit per gesture, rather than through the apvts, which would also
+//put every change the host automates into the history.
+
+//a bank's loop region and the tempo sync that goes with it (see SampleChopperAudioProcessor::setBankTempoSync)
+class LoopRegionEdit : public juce::UndoableAction
+{
+public:
+    struct Region
+    {
+        Interval<float> interval;
+        double speedPerBpm = 0.0;
+    };
+
+    LoopRegionEdit(SampleChopperAudioProcessor& processor, int bankIndex, const Region& before, const Region& after);
+
+    bool perform() override;
+    bool undo() override;
+
+    int getSizeInUnits() override
+    {
+        return static_cast<int>(sizeof(*this));
+    }
+
+    //every mouseDrag of one drag lands in the same transaction, they collapse into one edit from the first region to the last
+    juce::UndoableAction* createCoalescedAction(juce::UndoableAction* nextAction) override;
+
+private:
+    void apply(const Region& region);
+
+    SampleChopperAudioProcessor& processor;
+    int bankIndex;
+    Region before, after;
+};
+
+//one step turned on or off, on the pattern that was selected at the time
+class StepEdit : public juce::UndoableAction
+{
+public:
+    StepEdit(SequencerEngine& engine, int patternIndex, int bank, int step, bool isOn);
+
+    bool perform() override;
+    bool undo() override;
+
+    int getSizeInUnits() override
+    {
+        return static_cast<int>(sizeof(*this));
+    }
+
+private:
+    SequencerEngine& engine;
+    juce::uint8 patternIndex, bank, step; //all fit in a byte, see SequencerEngine
+    bool isOn;
+};
+
+//one parameter from where a gesture started to where it ended, normalised
+class ParameterEdit : public juce::UndoableAction
+{
+public:
+    ParameterEdit(juce::AudioProcessorParameter& parameter, float before, float after);
+
+    bool perform() override;
+    bool undo() override;
+
+    int getSizeInUnits() override
+    {
+        return static_cast<int>(sizeof(*this));
+    }
+
+private:
+    juce::AudioProcessorParameter& parameter;
+    float before, after;
+};
+
+//Turns the editor's parameter gestures (a slider drag, a button click) into ParameterEdits, each its own undo step.
+//The host doesn't start a gesture when it automates a parameter, so automation never reaches the history.
+class ParameterGestureRecorder : private juce::AudioProcessorParameter::Listener
+{
+public:
+    ParameterGestureRecorder(juce::AudioProcessor& processor, juce::UndoManager& undoManager); //after the parameters are added
+    ~ParameterGestureRecorder() override;
+
+private:
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
+
+    juce::AudioProcessor& processor;
+    juce::UndoManager& undoManager;
+    std::vector<float> gestureStartValues; //per parameter index, message thread only
+
+    JUCE_DECLARE_NON_COPYABLE (ParameterGestureRecorder)
+};
@@ -124,6 +124,8 @@ void WaveformDisplay::paint (juce::Graphics& g)
             }
         }
         
+        drawBeatGrid(g);
+        
     }
     
     else
@@ -151,9 +153,58 @@ bool WaveformDisplay::loadURL(const juce::URL &url)
     fileLoaded = audioThumbnail.setSource(new juce::URLInputSource(url));
     controllerThumbnail.setSource(new juce::URLInputSource(url));
     
+    beatGrid = {};
+    
     return fileLoaded;
 }
 
+void WaveformDisplay::loadSample(const SampleBuffer& sample)
+{
+    for(auto* thumbnail : {&audioThumbnail, &controllerThumbnail})
+    {
+        thumbnail->reset(sample.getNumChannels(), sample.getSampleRate(), sample.getNumSamples());
+        thumbnail->addBlock(0, sample.getAudio(), 0, sample.getNumSamples());
+    }
+    
+    fileLoaded = true;
+    beatGrid = {};
+    transientsTimeStamps.clear(); //they came from the last file
+}
+
+void WaveformDisplay::drawBeatGrid(juce::Graphics& g)
+{
+    const double visibleRange = waveformEnd - waveformStart;
+    
+    if(!beatGrid.isValid() || visibleRange <= 0)
+    {
+        return;
+    }
+    
+    const double beatLength = beatGrid.getBeatLength();
+    const int waveformHeight = static_cast<int>(scrollerStartY);
+    
+    //lines closer together than this are skipped, zoomed out a long file would just be a grey block
+    const bool drawBeats = beatLength / visibleRange * getWidth() >= 4.0;
+    
+    //first beat in view, counted from the downbeat so every beatsPerBar'th one is a bar line
+    double beatIndex = std::ceil((waveformStart - beatGrid.firstDownbeat) / beatLength);
+    
+    for(double time = beatGrid.firstDownbeat + beatIndex * beatLength; time <= waveformEnd; time += beatLength, beatIndex++)
+    {
+        const bool isBar = static_cast<int>(std::fmod(beatIndex, beatGrid.beatsPerBar) + beatGrid.beatsPerBar) % beatGrid.beatsPerBar == 0;
+        
+        if(time < 0 || (!isBar && !drawBeats))
+        {
+            continue;
+        }
+        
+        const int x = static_cast<int>((time - waveformStart) / visibleRange * getWidth());
+        
+        g.setColour(isBar ? juce::Colours::white.withAlpha(0.7f) : juce::Colours::white.withAlpha(0.25f));
+        g.drawVerticalLine(x, 0.0f, static_cast<float>(waveformHeight));
+    }
+}
+
 bool WaveformDisplay::isInterestedInFileDrag(const juce::StringArray& files)
 {
     return true;
@@ -347,44 +398,11 @@ void WaveformDisplay::detectTransients(juce::File file)
     
     if( reader != nullptr)
     {
-        juce::AudioBuffer<float> buffer(reader->numChannels, static_cast<int>(reader->lengthInSamples));
-        reader->read(&buffer, 0, static_cast<int>(reader->lengthInSamples), 0, true, true);
-        //
-        const int numSamples = buffer.getNumSamples();
-        const int numChannels = buffer.getNumChannels();
-        const int windowSize = reader->sampleRate / windowSizeDivisor; //100ms window size
-        
-        
-        std::vector<float> windowEnergies;
-        //
-        for(int startSample = 0; startSample < numSamples - windowSize; startSample += windowSize)
-        {
-            float windowEnergy = 0.0f;
-            
-            for(int channel = 0; channel < numChannels; ++channel)
-            {
-                for(int i = startSample; i < startSample + windowSize; i++)
-                {
-                    float sample = buffer.getSample(channel, i);
-                    windowEnergy += sample * sample;
-                }
-            }
-            
-            windowEnergies.push_back(windowEnergy);
-        }
-        //
+        TransientDetector::Settings settings;
+        settings.sensitivity = transientSensitivity;
+        settings.windowSizeDivisor = windowSizeDivisor;
         
-        const float sensitivity = transientSensitivity;
-        for(int i = 1; i < windowEnergies.size(); i++)
-        {
-            float energyChange = windowEnergies[i] - windowEnergies[i - 1];
-            
-            if(energyChange > sensitivity)
-            {
-                float transientTime = static_cast<float>(i * windowSize) / reader->sampleRate;
-                transients.push_back(transientTime);
-            }
-        }
+        transients = TransientDetector::detect(*reader, settings);
     }
     
     transientsTimeStamps = transients;
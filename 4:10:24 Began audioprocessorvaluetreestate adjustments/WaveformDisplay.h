@@ -12,6 +12,9 @@
 
 #include <JuceHeader.h>
 #include "Interval.h"
+#include "TransientDetector.h"
+#include "BeatGrid.h"
+#include "SampleBuffer.h"
 
 //==============================================================================
 /*
@@ -31,6 +34,7 @@ public:
     
     //My functions
     bool loadURL(const juce::URL& url);
+    void loadSample(const SampleBuffer& sample); //audio with no file behind it, e.g. a recorded take
     
     void setFileDroppedCallback(std::function<void(const juce::URL&)> callback) //this is called in filesdropped and passed a url this is then assigned to dile droppedcallback which will then be passed to the editor
     {
@@ -94,7 +98,15 @@ public:
         DBG(static_cast<int>(showingTransients));
     }
     
+    //bar and beat lines over the waveform, cleared when a new file is loaded
+    void setBeatGrid(const BeatGrid& grid)
+    {
+        beatGrid = grid;
+    }
+    
 private:
+    
+    void drawBeatGrid(juce::Graphics& g);
                          
     //Rectangles used to resize the waveform
     int selectorStart = 0; //the initial starting point of selectors
@@ -114,6 +126,8 @@ private:
     int windowSizeDivisor = 20;
     bool showingTransients = true;
     
+    BeatGrid beatGrid;
+    
     
     std::vector<juce::Colour> myColours; //UI Colours
     